@@ -18,11 +18,13 @@
 #ifndef itkAnalyticSignalImageFilter_h
 #define itkAnalyticSignalImageFilter_h
 
+#include <algorithm>
 #include <complex>
 
 #include "itkComplexToComplex1DFFTImageFilter.h"
 #include "itkForward1DFFTImageFilter.h"
 #include "itkFrequencyDomain1DImageFilter.h"
+#include "itkNativeFFT1D.h"
 
 namespace itk
 {
@@ -49,6 +51,14 @@ namespace itk
  *
  * where U(k) is the unit step function.
  *
+ * By default, the forward transform, the optional frequency filter, the
+ * step function and the inverse transform each run over the whole image, the
+ * transforms with the 1D FFT backend selected by the object factories. In
+ * SinglePass mode, the work units rather run them one line after the other
+ * with fft1d::AnalyticSignalKernel, in buffers that stay in the cache, and
+ * only write the analytic signal to the output: the two complex intermediate
+ * images and their memory traffic are avoided.
+ *
  * \ingroup FourierTransform
  * \ingroup Ultrasound
  */
@@ -62,6 +72,8 @@ public:
   using InputImageType = TInputImage;
   using OutputImageType = TOutputImage;
   using OutputImageRegionType = typename OutputImageType::RegionType;
+  using ComplexType = typename OutputImageType::PixelType;
+  using RealType = typename NumericTraits<ComplexType>::ValueType;
 
   itkStaticConstMacro(ImageDimension, unsigned int, InputImageType::ImageDimension);
 
@@ -98,6 +110,24 @@ public:
     }
   }
 
+  /** Set/Get the size the lines are zero padded to before the transform, see
+   * Forward1DFFTImageFilter::SetPaddedLineSize(). The output lines have the
+   * padded size. */
+  virtual SizeValueType
+  GetPaddedLineSize() const
+  {
+    return this->m_FFTRealToComplexFilter->GetPaddedLineSize();
+  }
+  virtual void
+  SetPaddedLineSize(const SizeValueType size)
+  {
+    if (this->m_FFTRealToComplexFilter->GetPaddedLineSize() != size)
+    {
+      this->m_FFTRealToComplexFilter->SetPaddedLineSize(size);
+      this->Modified();
+    }
+  }
+
   virtual void
   SetFrequencyFilter(FrequencyFilterType * filter)
   {
@@ -108,6 +138,28 @@ public:
       this->Modified();
     }
   }
+  itkGetModifiableObjectMacro(FrequencyFilter, FrequencyFilterType);
+
+  /** Get the greatest prime factor of the line sizes transformed efficiently:
+   * the smallest of the forward and inverse backends in the default mode,
+   * the one of the native kernels in SinglePass mode. */
+  virtual SizeValueType
+  GetSizeGreatestPrimeFactor() const
+  {
+    if (this->m_SinglePass)
+    {
+      return fft1d::NativeFFT<RealType>::GreatestPrimeFactor;
+    }
+    return std::min(this->m_FFTRealToComplexFilter->GetSizeGreatestPrimeFactor(),
+                    this->m_FFTComplexToComplexFilter->GetSizeGreatestPrimeFactor());
+  }
+
+  /** Set/Get whether the transforms and the masking of each line are done in
+   * a single pass over the image, with the native FFT kernels. Defaults to
+   * false. */
+  itkSetMacro(SinglePass, bool);
+  itkGetConstMacro(SinglePass, bool);
+  itkBooleanMacro(SinglePass);
 
 protected:
   AnalyticSignalImageFilter();
@@ -118,6 +170,8 @@ protected:
 
   // These behave like their analogs in Forward1DFFTImageFilter.
   void
+  GenerateOutputInformation() override;
+  void
   GenerateInputRequestedRegion() override;
   void
   EnlargeOutputRequestedRegion(DataObject * output) override;
@@ -125,6 +179,10 @@ protected:
   void
   GenerateData() override;
 
+  /** GenerateData() in SinglePass mode. */
+  void
+  GenerateDataSinglePass();
+
   using FFTRealToComplexType = Forward1DFFTImageFilter<InputImageType, OutputImageType>;
   typename FFTRealToComplexType::Pointer m_FFTRealToComplexFilter;
 
@@ -133,6 +191,8 @@ protected:
 
 private:
   typename FrequencyFilterType::Pointer m_FrequencyFilter;
+
+  bool m_SinglePass = false;
 };
 } // namespace itk
 
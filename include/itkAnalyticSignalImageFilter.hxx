@@ -28,10 +28,15 @@
 #  include "itkFFTWComplexToComplex1DFFTImageFilter.h"
 #endif
 
+#include "itkFFT1DAnalyticSignalKernel.h"
+#include "itkFFT1DLineBatch.h"
+#include "itkFFT1DScratchArena.h"
 #include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkImageLinearIteratorWithIndex.h"
 #include "itkMetaDataObject.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -41,11 +46,37 @@ AnalyticSignalImageFilter<TInputImage, TOutputImage>::AnalyticSignalImageFilter(
   m_FFTRealToComplexFilter = FFTRealToComplexType::New();
   m_FFTComplexToComplexFilter = FFTComplexToComplexType::New();
   m_FFTComplexToComplexFilter->SetTransformDirection(FFTComplexToComplexType::INVERSE);
+  // the inverse transform overwrites the spectrum in our output buffer
+  m_FFTComplexToComplexFilter->InPlaceOn();
 
   this->SetDirection(0);
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+void
+AnalyticSignalImageFilter<TInputImage, TOutputImage>::GenerateOutputInformation()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+
+  if (!input || !output)
+  {
+    return;
+  }
+
+  // the output lines have the padded size
+  const unsigned int                   direction = this->GetDirection();
+  typename OutputImageType::RegionType outputLargestRegion = output->GetLargestPossibleRegion();
+  outputLargestRegion.SetSize(
+    direction, std::max(input->GetLargestPossibleRegion().GetSize(direction), this->GetPaddedLineSize()));
+  output->SetLargestPossibleRegion(outputLargestRegion);
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 void
 AnalyticSignalImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
@@ -123,6 +154,8 @@ AnalyticSignalImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & o
 
   const unsigned int direction = this->GetDirection();
   os << indent << "Direction: " << direction << std::endl;
+  os << indent << "PaddedLineSize: " << this->GetPaddedLineSize() << std::endl;
+  os << indent << "SinglePass: " << m_SinglePass << std::endl;
 
   os << indent << "FFTRealToComplexFilter: " << std::endl;
   m_FFTRealToComplexFilter->Print(os, indent);
@@ -140,6 +173,12 @@ template <typename TInputImage, typename TOutputImage>
 void
 AnalyticSignalImageFilter<TInputImage, TOutputImage>::GenerateData()
 {
+  if (m_SinglePass)
+  {
+    this->GenerateDataSinglePass();
+    return;
+  }
+
   this->AllocateOutputs();
 
   OutputImageType * output = this->GetOutput();
@@ -244,6 +283,60 @@ AnalyticSignalImageFilter<TInputImage, TOutputImage>::GenerateData()
   this->GraftOutput(m_FFTComplexToComplexFilter->GetOutput());
 }
 
+
+template <typename TInputImage, typename TOutputImage>
+void
+AnalyticSignalImageFilter<TInputImage, TOutputImage>::GenerateDataSinglePass()
+{
+  this->AllocateOutputs();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+  const unsigned int     direction = this->GetDirection();
+  const SizeValueType    inputLineSize = input->GetRequestedRegion().GetSize(direction);
+  // the input lines are zero padded up to the output line size, without
+  // copying the zeros: the forward transform skips them
+  const SizeValueType lineSize = output->GetRequestedRegion().GetSize(direction);
+
+  // shared by the work units, see fft1d::ForEachLineTile
+  const fft1d::AnalyticSignalKernel<RealType> kernel(
+    lineSize, m_FrequencyFilter.IsNotNull() ? m_FrequencyFilter->GetModifiableFilterFunction() : nullptr);
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegionRestrictDirection<ImageDimension>(
+    direction,
+    output->GetRequestedRegion(),
+    [&](const OutputImageRegionType & lambdaRegion) {
+      const IndexValueType inputLineStart = input->GetRequestedRegion().GetIndex(direction);
+
+      fft1d::ScratchBuffer<RealType>    inputBuffer(fft1d::MaximumLineTileSize * inputLineSize);
+      fft1d::ScratchBuffer<ComplexType> outputBuffer(fft1d::MaximumLineTileSize * lineSize);
+      fft1d::ScratchBuffer<ComplexType> workBuffer(kernel.GetWorkSize());
+
+      fft1d::ForEachLineTile(
+        lambdaRegion,
+        direction,
+        fft1d::MaximumLineTileSize,
+        [&](const typename OutputImageType::IndexType & tileStart, SizeValueType numberOfLines) {
+          typename InputImageType::IndexType inputTileStart = tileStart;
+          inputTileStart[direction] = inputLineStart;
+          fft1d::GatherLineTile(input, inputTileStart, direction, inputLineSize, numberOfLines, inputBuffer.data());
+
+          for (SizeValueType line = 0; line < numberOfLines; ++line)
+          {
+            kernel.Transform(inputBuffer.data() + line * inputLineSize,
+                             inputLineSize,
+                             outputBuffer.data() + line * lineSize,
+                             workBuffer.data());
+          }
+
+          fft1d::ScatterLineTile(output, tileStart, direction, lineSize, numberOfLines, outputBuffer.data());
+        });
+    },
+    this);
+}
+
 } // end namespace itk
 
 #endif // itkAnalyticSignalImageFilter_hxx
@@ -20,17 +20,47 @@
 
 #include "itkAddImageFilter.h"
 #include "itkComplexToModulusImageFilter.h"
-#include "itkConstantPadImageFilter.h"
 #include "itkRegionFromReferenceImageFilter.h"
 #include "itkImageToImageFilter.h"
 #include "itkImage.h"
 #include "itkLog10ImageFilter.h"
 
 #include "itkAnalyticSignalImageFilter.h"
+#include "itkFFT1DAnalyticSignalKernel.h"
+#include "itkFFT1DScratchArena.h"
+#include "itkFFT1DWorkBufferPool.h"
+#include "itkHilbertFIRAnalyticSignalImageFilter.h"
+#include "UltrasoundExport.h"
+
+#include <atomic>
+#include <memory>
 
 namespace itk
 {
 
+/** \class BModeImageFilterEnums
+ * \brief Contains the enums used by BModeImageFilter.
+ * \ingroup Ultrasound
+ */
+class BModeImageFilterEnums
+{
+public:
+  /** \class EnvelopeMethod
+   * \ingroup Ultrasound
+   * Method the analytic signal, whose modulus is the envelope, is computed
+   * with. */
+  enum class EnvelopeMethod : uint8_t
+  {
+    /** AnalyticSignalImageFilter, with FFTs over the whole lines. */
+    FFT,
+    /** HilbertFIRAnalyticSignalImageFilter, with a time domain FIR. */
+    HilbertFIR
+  };
+};
+// Define how to print enumeration
+extern Ultrasound_EXPORT std::ostream &
+                         operator<<(std::ostream & out, const BModeImageFilterEnums::EnvelopeMethod value);
+
 /**
  * \class BModeImageFilter
  *
@@ -43,6 +73,37 @@ namespace itk
  * Use SetFrequencyFilter() to add a filtering step before the analytic
  * signal computation.
  *
+ * The lines are zero padded to the smallest size with no prime factor
+ * greater than the FFT backends support, see
+ * fft1d::PaddedSize::ComputeSmallestSize(). With PadToFastestSize on, they are
+ * rather padded to the size measured to be the fastest with the native
+ * kernels, which may differ from a run or machine to another. All the engines
+ * pad to the same size.
+ *
+ * By default, the envelope and its logarithm are computed by a pipeline of
+ * filters, each of which runs over the whole image. In SinglePass mode, the
+ * work units rather compute the analytic signal of each line, zero padded in
+ * a buffer, with fft1d::AnalyticSignalKernel, and write log10(|a(x)| + 1)
+ * straight into the output line, without any intermediate image.
+ *
+ * For live imaging, FrameStream mode keeps the state of the single pass
+ * engine between the updates: the transforms and the line buffers of the
+ * work units are only made again when the line size or the frequency filter
+ * change. The ReleaseDataBeforeUpdateFlag is turned off while in FrameStream
+ * mode, so that the output keeps its pixel container between the updates and
+ * AllocateOutputs() reuses it as long as the frames have the same size.
+ * GetNumberOfAllocations() counts the allocations of that state, and no
+ * longer increases once the first frame of a geometry has been processed.
+ * Note that a filter running in place downstream takes the output buffer of
+ * every frame away; turn InPlace off on it.
+ *
+ * With the HilbertFIR EnvelopeMethod, the analytic signal is rather computed
+ * by a HilbertFIRAnalyticSignalImageFilter, without any padding: only the
+ * requested lines and a halo of HilbertFIRKernelRadius pixels are read, so
+ * the output can be streamed along the direction, at the cost of a less
+ * accurate envelope at low and high frequencies. The frequency filter and the
+ * SinglePass and FrameStream modes only apply to the FFT method.
+ *
  * \sa AnalyticSignalImageFilter
  *
  * \ingroup Ultrasound
@@ -82,6 +143,9 @@ public:
   using InputRegionType = typename InputImageType::RegionType;
   using InputSizeType = typename InputImageType::SizeType;
   using InputIndexType = typename InputImageType::IndexType;
+  using OutputRegionType = typename OutputImageType::RegionType;
+  using ComplexType = typename ComplexImageType::PixelType;
+  using RealType = typename NumericTraits<ComplexType>::ValueType;
 
   /** Run-time type information (and related methods) */
   itkTypeMacro(BModeImageFilter, ImageToImageFilter);
@@ -91,11 +155,14 @@ public:
 
   using FrequencyFilterType = FrequencyDomain1DImageFilter<ComplexImageType, ComplexImageType>;
 
+  using EnvelopeMethodEnum = BModeImageFilterEnums::EnvelopeMethod;
+
   /** Set the direction in which the envelope is to be calculated. */
   virtual void
   SetDirection(unsigned int direction)
   {
     this->m_AnalyticFilter->SetDirection(direction);
+    this->m_HilbertFIRFilter->SetDirection(direction);
     this->Modified();
   }
 
@@ -112,6 +179,83 @@ public:
     m_AnalyticFilter->SetFrequencyFilter(filter);
   }
 
+  /** Set/Get whether the envelope and its logarithm are computed in a single
+   * pass over the image, see AnalyticSignalImageFilter::SetSinglePass().
+   * Defaults to false. */
+  itkSetMacro(SinglePass, bool);
+  itkGetConstMacro(SinglePass, bool);
+  itkBooleanMacro(SinglePass);
+
+  /** Set/Get whether the lines are zero padded to the size measured to be the
+   * fastest, see fft1d::PaddedSize::ComputeFastestSize(), rather than to the
+   * smallest one. The output then depends on the timings of the machine.
+   * Defaults to false. */
+  itkSetMacro(PadToFastestSize, bool);
+  itkGetConstMacro(PadToFastestSize, bool);
+  itkBooleanMacro(PadToFastestSize);
+
+  /** Set/Get whether the updates process the frames of a stream, keeping the
+   * state of the single pass engine and the output pixel container between
+   * them. Implies SinglePass. The ReleaseDataBeforeUpdateFlag is off while in
+   * FrameStream mode, and set back to its former value after.
+   *
+   * A downstream filter running in place takes the output buffer of every
+   * frame away, so that a new one is allocated for each frame, silently; turn
+   * InPlace off on it. Defaults to false. */
+  virtual void
+  SetFrameStream(bool frameStream)
+  {
+    if (this->m_FrameStream != frameStream)
+    {
+      this->m_FrameStream = frameStream;
+      if (frameStream)
+      {
+        this->m_ReleaseDataBeforeUpdateFlagBeforeFrameStream = this->GetReleaseDataBeforeUpdateFlag();
+        this->ReleaseDataBeforeUpdateFlagOff();
+      }
+      else
+      {
+        this->SetReleaseDataBeforeUpdateFlag(this->m_ReleaseDataBeforeUpdateFlagBeforeFrameStream);
+      }
+      this->Modified();
+    }
+  }
+  itkGetConstMacro(FrameStream, bool);
+  itkBooleanMacro(FrameStream);
+
+  /** Set/Get the method the analytic signal is computed with. Defaults to
+   * FFT. */
+  itkSetMacro(EnvelopeMethod, EnvelopeMethodEnum);
+  itkGetConstMacro(EnvelopeMethod, EnvelopeMethodEnum);
+
+  /** Set/Get the kernel radius of the FIR Hilbert transformer of the
+   * HilbertFIR EnvelopeMethod, see
+   * HilbertFIRAnalyticSignalImageFilter::SetKernelRadius(). */
+  virtual void
+  SetHilbertFIRKernelRadius(unsigned int radius)
+  {
+    if (this->m_HilbertFIRFilter->GetKernelRadius() != radius)
+    {
+      this->m_HilbertFIRFilter->SetKernelRadius(radius);
+      this->Modified();
+    }
+  }
+  virtual unsigned int
+  GetHilbertFIRKernelRadius() const
+  {
+    return this->m_HilbertFIRFilter->GetKernelRadius();
+  }
+
+  /** Number of allocations of the single pass engine: its transforms, the
+   * line buffers of its work units and, in FrameStream mode, the output
+   * buffers, counted as the new pixel containers of the output and the
+   * reallocations of their buffers. */
+  SizeValueType
+  GetNumberOfAllocations() const
+  {
+    return m_NumberOfAllocations;
+  }
+
 protected:
   BModeImageFilter();
   ~BModeImageFilter() {}
@@ -122,6 +266,40 @@ protected:
   virtual void
   GenerateData() override;
 
+  using KernelType = fft1d::AnalyticSignalKernel<RealType>;
+
+  /** Buffers of a work unit of the single pass engine. */
+  struct LineBuffers
+  {
+    fft1d::ScratchBuffer<RealType>        InputBuffer;
+    fft1d::ScratchBuffer<OutputPixelType> OutputBuffer;
+    fft1d::ScratchBuffer<ComplexType>     AnalyticBuffer;
+    fft1d::ScratchBuffer<ComplexType>     WorkBuffer;
+  };
+  using LineBuffersPoolType = fft1d::WorkBufferPool<LineBuffers>;
+
+  /** GenerateData() in SinglePass mode, with the buffers of the work units
+   * checked out of linePool. */
+  void
+  GenerateDataSinglePass(const KernelType & kernel, LineBuffersPoolType & linePool);
+
+  /** Make the frame stream state again when the line size, its padded size
+   * or the frequency filter changed. */
+  void
+  UpdateFrameStreamState(SizeValueType lineSize, SizeValueType transformLineSize);
+
+  /** Allocate the line buffers of a work unit. */
+  std::unique_ptr<LineBuffers>
+  CreateLineBuffers(SizeValueType lineSize, const KernelType & kernel);
+
+  /** Filter function of the frequency filter, if any. */
+  FrequencyDomain1DFilterFunction *
+  GetFrequencyFilterFunction();
+
+  /** Size the lines of lineSize values are zero padded to. */
+  SizeValueType
+  ComputeTransformLineSize(SizeValueType lineSize) const;
+
   // These behave like their analogs in Forward1DFFTImageFilter.
   virtual void
   GenerateInputRequestedRegion() override;
@@ -130,8 +308,8 @@ protected:
 
   /** Component filters. */
   using AnalyticType = AnalyticSignalImageFilter<InputImageType, ComplexImageType>;
+  using HilbertFIRType = HilbertFIRAnalyticSignalImageFilter<InputImageType, ComplexImageType>;
   using ComplexToModulusType = ComplexToModulusImageFilter<typename AnalyticType::OutputImageType, OutputImageType>;
-  using PadType = ConstantPadImageFilter<InputImageType, InputImageType>;
   using AddConstantType = AddImageFilter<InputImageType, InputImageType>;
   using LogType = Log10ImageFilter<InputImageType, OutputImageType>;
   using ROIType = RegionFromReferenceImageFilter<OutputImageType, OutputImageType>;
@@ -142,11 +320,27 @@ private:
   operator=(const Self &); // purposely not implemented
 
   typename AnalyticType::Pointer         m_AnalyticFilter;
+  typename HilbertFIRType::Pointer       m_HilbertFIRFilter;
   typename ComplexToModulusType::Pointer m_ComplexToModulusFilter;
-  typename PadType::Pointer              m_PadFilter;
   typename AddConstantType::Pointer      m_AddConstantFilter;
   typename LogType::Pointer              m_LogFilter;
   typename ROIType::Pointer              m_ROIFilter;
+
+  bool               m_SinglePass = false;
+  bool               m_PadToFastestSize = false;
+  bool               m_FrameStream = false;
+  bool               m_ReleaseDataBeforeUpdateFlagBeforeFrameStream = true;
+  EnvelopeMethodEnum m_EnvelopeMethod = EnvelopeMethodEnum::FFT;
+
+  // frame stream state
+  std::unique_ptr<const KernelType>               m_FrameKernel;
+  LineBuffersPoolType                             m_FrameLinePool;
+  SizeValueType                                   m_FrameLineSize = 0;
+  const FrequencyDomain1DFilterFunction *         m_FrameFilterFunction = nullptr;
+  ModifiedTimeType                                m_FrameFilterFunctionMTime = 0;
+  typename OutputImageType::PixelContainerPointer m_FrameOutputContainer;
+  const OutputPixelType *                         m_FrameOutputBuffer = nullptr;
+  std::atomic<SizeValueType>                      m_NumberOfAllocations{ 0 };
 };
 
 } // end namespace itk
@@ -20,11 +20,16 @@
 
 #include "itkBModeImageFilter.h"
 
+#include "itkFFT1DLineBatch.h"
+#include "itkFFT1DPaddedSize.h"
 #include "itkMetaDataDictionary.h"
 
 #include <algorithm>
+#include <cmath>
+#include <new>
 #include <sstream>
 #include <string>
+#include <utility>
 
 namespace itk
 {
@@ -33,8 +38,8 @@ template <typename TInputImage, typename TOutputImage, typename TComplexImage>
 BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::BModeImageFilter()
 {
   m_AnalyticFilter = AnalyticType::New();
+  m_HilbertFIRFilter = HilbertFIRType::New();
   m_ComplexToModulusFilter = ComplexToModulusType::New();
-  m_PadFilter = PadType::New();
   m_AddConstantFilter = AddConstantType::New();
   m_LogFilter = LogType::New();
   m_ROIFilter = ROIType::New();
@@ -42,7 +47,6 @@ BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::BModeImageFilter()
   // Avoid taking the log of zero.  Assuming that the original input is coming
   // from a digitizer that outputs integer types, so 1 is small.
   m_AddConstantFilter->SetConstant2(1);
-  m_PadFilter->SetConstant(0.);
 
   m_ComplexToModulusFilter->SetInput(m_AnalyticFilter->GetOutput());
   m_ROIFilter->SetInput(m_ComplexToModulusFilter->GetOutput());
@@ -55,6 +59,13 @@ void
 BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+
+  os << indent << "SinglePass: " << m_SinglePass << std::endl;
+  os << indent << "PadToFastestSize: " << m_PadToFastestSize << std::endl;
+  os << indent << "FrameStream: " << m_FrameStream << std::endl;
+  os << indent << "EnvelopeMethod: " << m_EnvelopeMethod << std::endl;
+  os << indent << "HilbertFIRKernelRadius: " << this->GetHilbertFIRKernelRadius() << std::endl;
+  os << indent << "NumberOfAllocations: " << m_NumberOfAllocations << std::endl;
 }
 
 
@@ -69,6 +80,19 @@ BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::GenerateInputRequest
   InputImageType *  inputPtr = const_cast<InputImageType *>(this->GetInput());
   OutputImageType * outputPtr = this->GetOutput();
 
+  if (m_EnvelopeMethod == EnvelopeMethodEnum::HilbertFIR)
+  {
+    // the FIR transformer only needs a halo around the requested lines
+    typename InputImageType::SizeType haloRadius;
+    haloRadius.Fill(0);
+    haloRadius[this->GetDirection()] = this->GetHilbertFIRKernelRadius();
+    InputRegionType inputRequestedRegion = outputPtr->GetRequestedRegion();
+    inputRequestedRegion.PadByRadius(haloRadius);
+    inputRequestedRegion.Crop(inputPtr->GetLargestPossibleRegion());
+    inputPtr->SetRequestedRegion(inputRequestedRegion);
+    return;
+  }
+
   // we need to compute the input requested region (size and start index)
   using OutputSizeType = const typename OutputImageType::SizeType &;
   OutputSizeType outputRequestedRegionSize = outputPtr->GetRequestedRegion().GetSize();
@@ -98,6 +122,12 @@ template <typename TInputImage, typename TOutputImage, typename TComplexImage>
 void
 BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::EnlargeOutputRequestedRegion(DataObject * output)
 {
+  if (m_EnvelopeMethod == EnvelopeMethodEnum::HilbertFIR)
+  {
+    // the output can be streamed along the direction
+    return;
+  }
+
   OutputImageType * outputPtr = dynamic_cast<OutputImageType *>(output);
 
   // we need to enlarge the region in the fft direction to the
@@ -132,45 +162,54 @@ BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::GenerateData()
   OutputImageType *      outputPtr = this->GetOutput();
 
   const unsigned int                direction = m_AnalyticFilter->GetDirection();
-  typename InputImageType::SizeType size = inputPtr->GetLargestPossibleRegion().GetSize();
+  const typename InputImageType::SizeType & size = inputPtr->GetLargestPossibleRegion().GetSize();
 
-  // Zero padding.  FFT direction should be factorable by 2 for all FFT
-  // implementations to work.
-  unsigned int n = size[direction];
-  while (n % 2 == 0)
+  // no padding: the FIR transformer reads a halo of the input lines
+  if (m_EnvelopeMethod == EnvelopeMethodEnum::HilbertFIR)
   {
-    n /= 2;
+    m_HilbertFIRFilter->SetInput(inputPtr);
+    m_ComplexToModulusFilter->SetInput(m_HilbertFIRFilter->GetOutput());
+    m_AddConstantFilter->SetInput(m_ComplexToModulusFilter->GetOutput());
+    m_LogFilter->GraftOutput(outputPtr);
+    m_LogFilter->Update();
+    this->GraftOutput(m_LogFilter->GetOutput());
+    return;
   }
-  bool doPadding;
-  if (n == 1)
+
+  // Zero padding, to a size the transforms are fast for, the same for all
+  // the engines so that they compute the same envelope.
+  const SizeValueType lineSize = size[direction];
+  const SizeValueType transformLineSize = this->ComputeTransformLineSize(lineSize);
+  if (m_FrameStream)
   {
-    doPadding = false;
+    this->UpdateFrameStreamState(lineSize, transformLineSize);
+    this->GenerateDataSinglePass(*m_FrameKernel, m_FrameLinePool);
+    return;
   }
-  else
+  if (m_SinglePass)
   {
-    doPadding = true;
+    const KernelType kernel(transformLineSize, this->GetFrequencyFilterFunction());
+    ++m_NumberOfAllocations;
+    LineBuffersPoolType linePool;
+    this->GenerateDataSinglePass(kernel, linePool);
+    return;
   }
+
+  m_ComplexToModulusFilter->SetInput(m_AnalyticFilter->GetOutput());
+  const bool doPadding = transformLineSize != lineSize;
   if (doPadding)
   {
-    n = size[direction];
-    unsigned int newSizeDirection = 1;
-    while (newSizeDirection < n)
-    {
-      newSizeDirection *= 2;
-    }
-    typename InputImageType::SizeType padSize;
-    padSize.Fill(0);
-    padSize[direction] = newSizeDirection - size[direction];
-    size[direction] = newSizeDirection;
-    m_PadFilter->SetPadUpperBound(padSize);
-    m_PadFilter->SetInput(inputPtr);
-    m_AnalyticFilter->SetInput(m_PadFilter->GetOutput());
+    // the forward transform pads the lines on the fly, without a padded copy
+    // of the input
+    m_AnalyticFilter->SetPaddedLineSize(transformLineSize);
+    m_AnalyticFilter->SetInput(inputPtr);
     m_ROIFilter->SetReferenceImage(inputPtr);
     m_ROIFilter->SetInput(m_ComplexToModulusFilter->GetOutput());
     m_AddConstantFilter->SetInput(m_ROIFilter->GetOutput());
   }
   else // padding is not required
   {
+    m_AnalyticFilter->SetPaddedLineSize(0);
     m_AnalyticFilter->SetInput(inputPtr);
     m_AddConstantFilter->SetInput(m_ComplexToModulusFilter->GetOutput());
   }
@@ -179,6 +218,149 @@ BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::GenerateData()
   this->GraftOutput(m_LogFilter->GetOutput());
 }
 
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+SizeValueType
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::ComputeTransformLineSize(SizeValueType lineSize) const
+{
+  // the native kernels of the single pass engine transform any size, so the
+  // backends of the pipeline bound the prime factors
+  const SizeValueType greatestPrimeFactor = m_AnalyticFilter->GetSizeGreatestPrimeFactor();
+  if (m_PadToFastestSize)
+  {
+    return fft1d::PaddedSize::ComputeFastestSize(lineSize, greatestPrimeFactor);
+  }
+  return fft1d::PaddedSize::ComputeSmallestSize(lineSize, greatestPrimeFactor);
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+FrequencyDomain1DFilterFunction *
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::GetFrequencyFilterFunction()
+{
+  FrequencyFilterType * frequencyFilter = m_AnalyticFilter->GetModifiableFrequencyFilter();
+  return frequencyFilter != nullptr ? frequencyFilter->GetModifiableFilterFunction() : nullptr;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+void
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::UpdateFrameStreamState(SizeValueType lineSize,
+                                                                                   SizeValueType transformLineSize)
+{
+  // the kernel sets the signal size of the filter function, which modifies
+  // it, so its modified time is read once the kernel is made
+  FrequencyDomain1DFilterFunction * filterFunction = this->GetFrequencyFilterFunction();
+  if (m_FrameKernel == nullptr || lineSize != m_FrameLineSize || transformLineSize != m_FrameKernel->GetLineSize() ||
+      filterFunction != m_FrameFilterFunction ||
+      (filterFunction != nullptr && filterFunction->GetMTime() != m_FrameFilterFunctionMTime))
+  {
+    m_FrameKernel.reset(new KernelType(transformLineSize, filterFunction));
+    ++m_NumberOfAllocations;
+    m_FrameLineSize = lineSize;
+    m_FrameFilterFunction = filterFunction;
+    m_FrameFilterFunctionMTime = filterFunction != nullptr ? filterFunction->GetMTime() : 0;
+
+    // a set of line buffers for each work unit, so that none is allocated
+    // while the frames are processed
+    m_FrameLinePool.Clear();
+    for (unsigned int workUnit = 0; workUnit < this->GetNumberOfWorkUnits(); ++workUnit)
+    {
+      m_FrameLinePool.CheckIn(this->CreateLineBuffers(lineSize, *m_FrameKernel));
+    }
+  }
+
+  // With the ReleaseDataBeforeUpdateFlag off, AllocateOutputs() keeps the
+  // pixel container of the output, and its buffer as long as the frames have
+  // the same size. A new container, made when the output data is released or
+  // taken by a downstream filter, or a reallocated buffer is an allocation.
+  // The former container is held, so that a new one cannot get its address.
+  OutputImageType *                          output = this->GetOutput();
+  typename OutputImageType::PixelContainer * outputContainer = output->GetPixelContainer();
+  const OutputPixelType *                    outputBuffer = output->GetBufferPointer();
+  if (outputContainer != m_FrameOutputContainer.GetPointer() || outputBuffer != m_FrameOutputBuffer)
+  {
+    ++m_NumberOfAllocations;
+    m_FrameOutputContainer = outputContainer;
+    m_FrameOutputBuffer = outputBuffer;
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+auto
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::CreateLineBuffers(SizeValueType      lineSize,
+                                                                              const KernelType & kernel)
+  -> std::unique_ptr<LineBuffers>
+{
+  std::unique_ptr<LineBuffers> buffers(new LineBuffers);
+  try
+  {
+    buffers->InputBuffer.Allocate(fft1d::MaximumLineTileSize * lineSize);
+    buffers->OutputBuffer.Allocate(fft1d::MaximumLineTileSize * lineSize);
+    buffers->AnalyticBuffer.Allocate(kernel.GetLineSize());
+    buffers->WorkBuffer.Allocate(kernel.GetWorkSize());
+  }
+  catch (std::bad_alloc &)
+  {
+    itkExceptionMacro("Problem allocating memory for internal computations");
+  }
+  ++m_NumberOfAllocations;
+  return buffers;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+void
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::GenerateDataSinglePass(const KernelType &    kernel,
+                                                                                   LineBuffersPoolType & linePool)
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+  const unsigned int     direction = this->GetDirection();
+  const SizeValueType    lineSize = input->GetRequestedRegion().GetSize(direction);
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegionRestrictDirection<ImageDimension>(
+    direction,
+    output->GetRequestedRegion(),
+    [&](const OutputRegionType & lambdaRegion) {
+      // the kernel is shared by the work units, see fft1d::ForEachLineTile
+      std::unique_ptr<LineBuffers> buffers =
+        linePool.CheckOut([&]() { return this->CreateLineBuffers(lineSize, kernel); });
+      fft1d::ScratchBuffer<RealType> &        inputBuffer = buffers->InputBuffer;
+      fft1d::ScratchBuffer<OutputPixelType> & outputBuffer = buffers->OutputBuffer;
+      fft1d::ScratchBuffer<ComplexType> &     analytic = buffers->AnalyticBuffer;
+      fft1d::ScratchBuffer<ComplexType> &     workBuffer = buffers->WorkBuffer;
+
+      fft1d::ForEachLineTile(
+        lambdaRegion,
+        direction,
+        fft1d::MaximumLineTileSize,
+        [&](const typename OutputImageType::IndexType & tileStart, SizeValueType numberOfLines) {
+          fft1d::GatherLineTile(input, tileStart, direction, lineSize, numberOfLines, inputBuffer.data());
+
+          for (SizeValueType line = 0; line < numberOfLines; ++line)
+          {
+            kernel.Transform(inputBuffer.data() + line * lineSize, lineSize, analytic.data(), workBuffer.data());
+            // only the values of the input line are kept of the padded one;
+            // 1 is added to avoid taking the log of zero
+            OutputPixelType * outputLine = outputBuffer.data() + line * lineSize;
+            for (SizeValueType k = 0; k < lineSize; ++k)
+            {
+              outputLine[k] = static_cast<OutputPixelType>(std::log10(std::abs(analytic[k]) + RealType(1)));
+            }
+          }
+
+          fft1d::ScatterLineTile(output, tileStart, direction, lineSize, numberOfLines, outputBuffer.data());
+        });
+
+      linePool.CheckIn(std::move(buffers));
+    },
+    this);
+}
+
 } // end namespace itk
 
 #endif
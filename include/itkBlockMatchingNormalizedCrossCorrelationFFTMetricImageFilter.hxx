@@ -20,6 +20,7 @@
 
 #include "itkBlockMatchingNormalizedCrossCorrelationFFTMetricImageFilter.h"
 
+#include "itkFFT1DPaddedSize.h"
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIterator.h"
 
@@ -97,19 +98,12 @@ NormalizedCrossCorrelationFFTMetricImageFilter<TFixedImage, TMovingImage, TMetri
   typename MetricImageRegionType::SizeType          paddedSize;
   for (unsigned int ii = 0; ii < ImageDimension; ++ii)
   {
-    SizeValueType padSize = std::max(static_cast<SizeValueType>(0), fixedMinusMeanSize[ii] - 1);
-    if (m_SizeGreatestPrimeFactor > 1)
-    {
-      while (Math::GreatestPrimeFactor(movingMinusMeanSize[ii] + padSize) > m_SizeGreatestPrimeFactor)
-      {
-        ++padSize;
-      }
-    }
-    else if (m_SizeGreatestPrimeFactor == 1)
-    {
-      // make sure the total size is even
-      padSize += (movingMinusMeanSize[ii] + padSize) % 2;
-    }
+    // the smallest size with no prime factor greater than the FFT supports,
+    // or, for a greatest prime factor of 1, the smallest even size
+    const SizeValueType minimumPadSize = std::max(static_cast<SizeValueType>(0), fixedMinusMeanSize[ii] - 1);
+    const SizeValueType padSize =
+      fft1d::PaddedSize::ComputeSmallestSize(movingMinusMeanSize[ii] + minimumPadSize, m_SizeGreatestPrimeFactor) -
+      movingMinusMeanSize[ii];
     paddedIndex[ii] = movingMinusMeanIndex.GetIndex()[ii] - padSize / 2;
     paddedSize[ii] = movingMinusMeanSize[ii] + padSize;
   }
@@ -20,8 +20,9 @@
 
 #include <complex>
 
+#include "itkFFT1DBackendRegistry.h"
 #include "itkImage.h"
-#include "itkImageToImageFilter.h"
+#include "itkInPlaceImageFilter.h"
 
 namespace itk
 {
@@ -35,11 +36,15 @@ namespace itk
  * The dimension along which to apply to filter can be specified with
  * SetDirection() and GetDirection().
  *
+ * With InPlaceOn(), the transform overwrites the input buffer instead of
+ * allocating an output image, when the input and output image types are the
+ * same. The filter does not run in place by default.
+ *
  * \ingroup FourierTransform
  * \ingroup Ultrasound
  */
 template <typename TInputImage, typename TOutputImage = TInputImage>
-class ITK_TEMPLATE_EXPORT ComplexToComplex1DFFTImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+class ITK_TEMPLATE_EXPORT ComplexToComplex1DFFTImageFilter : public InPlaceImageFilter<TInputImage, TOutputImage>
 {
 public:
   ITK_DISALLOW_COPY_AND_ASSIGN(ComplexToComplex1DFFTImageFilter);
@@ -50,22 +55,42 @@ public:
   using OutputImageRegionType = typename OutputImageType::RegionType;
 
   using Self = ComplexToComplex1DFFTImageFilter;
-  using Superclass = ImageToImageFilter<InputImageType, OutputImageType>;
+  using Superclass = InPlaceImageFilter<InputImageType, OutputImageType>;
   using Pointer = SmartPointer<Self>;
   using ConstPointer = SmartPointer<const Self>;
 
   itkStaticConstMacro(ImageDimension, unsigned int, InputImageType::ImageDimension);
 
-  itkTypeMacro(ComplexToComplex1DFFTImageFilter, ImageToImageFilter);
+  itkTypeMacro(ComplexToComplex1DFFTImageFilter, InPlaceImageFilter);
 
   /** Customized object creation methods that support configuration-based
    * selection of FFT implementation.
    *
-   * Default implementation is VnlFFT1D.
+   * Default implementation is FFTW when available, NativeFFT1D otherwise.
+   * The backend set in fft1d::BackendRegistry, at run time or with the
+   * ITKUltrasound_FFT1D_BACKEND environment variable, overrides the default.
+   * AUTO_TUNE needs the size of the lines and creates the default
+   * implementation here, with a warning the first time.
    */
   static Pointer
   New();
 
+  using BackendType = fft1d::BackendRegistry::BackendType;
+
+  /** Create the filter of a given backend. Returns a null pointer when the
+   * backend is not available in this build or for this pixel type. DEFAULT
+   * and AUTO_TUNE create the default implementation. */
+  static Pointer
+  New(BackendType backend);
+
+  /** Create the filter of the fft1d::BackendRegistry backend for
+   * numberOfLines lines of lineSize pixels along direction, which is set as
+   * the Direction of the filter. With AUTO_TUNE, this is the backend that
+   * transformed such lines the fastest, timed on the first call for the size
+   * and direction. */
+  static Pointer
+  New(SizeValueType lineSize, SizeValueType numberOfLines, unsigned int direction = 0);
+
   /** Transform direction. */
   using TransformDirectionType = enum { DIRECT = 1, INVERSE };
 
@@ -118,7 +143,11 @@ private:
 #    ifndef itkVnlComplexToComplex1DFFTImageFilter_hxx
 #      ifndef itkFFTWComplexToComplex1DFFTImageFilter_h
 #        ifndef itkFFTWComplexToComplex1DFFTImageFilter_hxx
-#          include "itkComplexToComplex1DFFTImageFilter.hxx"
+#          ifndef itkNativeComplexToComplex1DFFTImageFilter_h
+#            ifndef itkNativeComplexToComplex1DFFTImageFilter_hxx
+#              include "itkComplexToComplex1DFFTImageFilter.hxx"
+#            endif
+#          endif
 #        endif
 #      endif
 #    endif
@@ -20,6 +20,7 @@
 
 #include "itkComplexToComplex1DFFTImageFilter.h"
 
+#include "itkNativeComplexToComplex1DFFTImageFilter.h"
 #include "itkVnlComplexToComplex1DFFTImageFilter.h"
 
 #if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
@@ -42,38 +43,128 @@ ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New()
 {
   Pointer smartPtr = ObjectFactory<Self>::Create();
 
-#ifdef ITKUltrasound_USE_clFFT
   if (smartPtr.IsNull())
   {
-    smartPtr =
-      dynamic_cast<Self *>(OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer());
+    smartPtr = New(fft1d::BackendRegistry::GetUntunedBackend());
   }
-#endif
-#ifdef ITK_USE_FFTWD
   if (smartPtr.IsNull())
   {
-    if (typeid(typename TInputImage::PixelType::value_type) == typeid(double))
-    {
-      smartPtr =
-        dynamic_cast<Self *>(FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer());
-    }
+    smartPtr = New(fft1d::BackendRegistry::DEFAULT);
   }
+
+  return smartPtr;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+typename ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
+ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New(BackendType backend)
+{
+  Pointer smartPtr;
+
+  switch (backend)
+  {
+    case fft1d::BackendRegistry::VNL:
+      smartPtr = VnlComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+      break;
+    case fft1d::BackendRegistry::FFTW:
+#ifdef ITK_USE_FFTWD
+      if (typeid(typename TInputImage::PixelType::value_type) == typeid(double))
+      {
+        smartPtr =
+          dynamic_cast<Self *>(FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer());
+      }
 #endif
 #ifdef ITK_USE_FFTWF
+      if (typeid(typename TInputImage::PixelType::value_type) == typeid(float))
+      {
+        smartPtr =
+          dynamic_cast<Self *>(FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer());
+      }
+#endif
+      break;
+    case fft1d::BackendRegistry::NATIVE:
+      smartPtr = NativeComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+      break;
+    case fft1d::BackendRegistry::OPENCL:
+#ifdef ITKUltrasound_USE_clFFT
+      smartPtr =
+        dynamic_cast<Self *>(OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer());
+#endif
+      break;
+    default:
+#ifdef ITKUltrasound_USE_clFFT
+      smartPtr =
+        dynamic_cast<Self *>(OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer());
+#endif
+#ifdef ITK_USE_FFTWD
+      if (smartPtr.IsNull())
+      {
+        if (typeid(typename TInputImage::PixelType::value_type) == typeid(double))
+        {
+          smartPtr =
+            dynamic_cast<Self *>(FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer());
+        }
+      }
+#endif
+#ifdef ITK_USE_FFTWF
+      if (smartPtr.IsNull())
+      {
+        if (typeid(typename TInputImage::PixelType::value_type) == typeid(float))
+        {
+          smartPtr =
+            dynamic_cast<Self *>(FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer());
+        }
+      }
+#endif
+      if (smartPtr.IsNull())
+      {
+        smartPtr = NativeComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+      }
+      break;
+  }
+
+  return smartPtr;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+typename ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
+ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New(SizeValueType lineSize,
+                                                                 SizeValueType numberOfLines,
+                                                                 unsigned int  direction)
+{
+  using RegistryType = fft1d::BackendRegistry;
+  using ValueType = typename TInputImage::PixelType::value_type;
+
+  Pointer smartPtr = ObjectFactory<Self>::Create();
+
   if (smartPtr.IsNull())
   {
-    if (typeid(typename TInputImage::PixelType::value_type) == typeid(float))
+    BackendType backend = RegistryType::GetBackend();
+    if (backend == RegistryType::AUTO_TUNE)
     {
-      smartPtr =
-        dynamic_cast<Self *>(FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer());
+      const auto timeBackend = [lineSize, numberOfLines, direction](BackendType candidate) -> double {
+        Pointer filter = New(candidate);
+        if (filter.IsNull())
+        {
+          return -1.0;
+        }
+        filter->SetDirection(direction);
+        const typename InputImageType::Pointer input =
+          RegistryType::MakeTuningImage<InputImageType>(lineSize, numberOfLines, direction);
+        return RegistryType::TimeFilter(filter.GetPointer(), input.GetPointer());
+      };
+      backend = RegistryType::GetTunedBackend<ValueType>(
+        RegistryType::COMPLEX_TO_COMPLEX, lineSize, numberOfLines, direction, timeBackend);
     }
+    smartPtr = New(backend);
   }
-#endif
-
   if (smartPtr.IsNull())
   {
-    smartPtr = VnlComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+    smartPtr = New(RegistryType::DEFAULT);
   }
+  smartPtr->SetDirection(direction);
 
   return smartPtr;
 }
@@ -83,7 +174,9 @@ template <typename TInputImage, typename TOutputImage>
 ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::ComplexToComplex1DFFTImageFilter()
   : m_Direction(0)
   , m_TransformDirection(DIRECT)
-{}
+{
+  this->InPlaceOff();
+}
 
 
 template <typename TInputImage, typename TOutputImage>
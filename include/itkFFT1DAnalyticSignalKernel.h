@@ -0,0 +1,118 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFFT1DAnalyticSignalKernel_h
+#define itkFFT1DAnalyticSignalKernel_h
+
+#include "itkFrequencyDomain1DFilterFunction.h"
+#include "itkIntTypes.h"
+#include "itkNativeFFT1D.h"
+
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+namespace itk
+{
+namespace fft1d
+{
+
+/** \class AnalyticSignalKernel
+ * \brief Analytic signal of a line, computed with the native FFT kernels.
+ *
+ * The forward transform of the line, zero padded to GetLineSize(), is
+ * weighted by the optional frequency filter function, the frequencies with a
+ * negative counterpart are doubled and the negative ones dropped, and the
+ * backward transform gives the analytic signal. The weights of the filter,
+ * of the step function and the 1 / GetLineSize() normalization are folded
+ * into a single table.
+ *
+ * The kernel is not modified by the transforms, so a single object can be
+ * shared by several threads as long as each one has its own work buffer.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TReal>
+class AnalyticSignalKernel
+{
+public:
+  using RealType = TReal;
+  using ComplexType = std::complex<RealType>;
+
+  /** The signal size of filterFunction, when given, is set to lineSize. */
+  explicit AnalyticSignalKernel(SizeValueType lineSize, FrequencyDomain1DFilterFunction * filterFunction = nullptr)
+    : m_LineSize(lineSize)
+    , m_ForwardFFT(lineSize)
+    , m_BackwardFFT(lineSize)
+    , m_Weights(lineSize / 2 + 1, static_cast<RealType>(2.0 / lineSize))
+  {
+    m_Weights[0] = static_cast<RealType>(1.0 / lineSize);
+    if (lineSize % 2 == 0)
+    {
+      m_Weights[lineSize / 2] = static_cast<RealType>(1.0 / lineSize);
+    }
+    if (filterFunction != nullptr)
+    {
+      filterFunction->SetSignalSize(lineSize);
+      for (SizeValueType k = 0; k < m_Weights.size(); ++k)
+      {
+        m_Weights[k] *= static_cast<RealType>(filterFunction->EvaluateIndex(k));
+      }
+    }
+  }
+
+  SizeValueType
+  GetLineSize() const
+  {
+    return m_LineSize;
+  }
+
+  /** Number of complex values the work buffer of Transform() must hold. */
+  SizeValueType
+  GetWorkSize() const
+  {
+    return m_LineSize + std::max(m_ForwardFFT.GetWorkSize(), m_BackwardFFT.GetWorkSize());
+  }
+
+  /** Write the GetLineSize() values of the analytic signal of the inputSize
+   * values of input, zero padded, to output. */
+  void
+  Transform(const RealType * input, SizeValueType inputSize, ComplexType * output, ComplexType * work) const
+  {
+    const SizeValueType numberOfBins = m_Weights.size();
+    ComplexType *       spectrum = work;
+    ComplexType *       fftWork = work + m_LineSize;
+    m_ForwardFFT.Forward(input, inputSize, spectrum, fftWork);
+    for (SizeValueType k = 0; k < numberOfBins; ++k)
+    {
+      spectrum[k] *= m_Weights[k];
+    }
+    std::fill(spectrum + numberOfBins, spectrum + m_LineSize, ComplexType(0));
+    m_BackwardFFT.Backward(spectrum, output, fftWork);
+  }
+
+private:
+  SizeValueType              m_LineSize;
+  const NativeRealFFT<TReal> m_ForwardFFT;
+  const NativeFFT<TReal>     m_BackwardFFT;
+  std::vector<RealType>      m_Weights;
+};
+
+} // end namespace fft1d
+} // end namespace itk
+
+#endif // itkFFT1DAnalyticSignalKernel_h
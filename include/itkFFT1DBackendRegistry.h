@@ -0,0 +1,340 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFFT1DBackendRegistry_h
+#define itkFFT1DBackendRegistry_h
+
+#include "itkIntTypes.h"
+#include "itkMacro.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <initializer_list>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace itk
+{
+namespace fft1d
+{
+
+/** \class BackendRegistry
+ * \brief Process-wide run time selection of the backend created by the New()
+ * methods of Forward1DFFTImageFilter, Inverse1DFFTImageFilter and
+ * ComplexToComplex1DFFTImageFilter.
+ *
+ * By default, the backend is chosen at compile time: OpenCL when
+ * ITKUltrasound_USE_clFFT is on, FFTW when it is available for the pixel
+ * precision, the native transforms otherwise. SetBackend(), or the
+ * ITKUltrasound_FFT1D_BACKEND environment variable read on first use, set to
+ * one of "default", "vnl", "fftw", "native", "opencl" or "auto", overrides
+ * this choice for the filters created afterwards. A backend that is not
+ * available in this build, or for the pixel precision, falls back to the
+ * default one.
+ *
+ * With AUTO_TUNE, the New(lineSize, numberOfLines, direction) methods of the
+ * filters time every available backend on lines of that size and direction
+ * the first time they see a (transform kind, line size, number of lines,
+ * direction, precision) combination, and create the fastest one; the winner
+ * is cached for the next calls. New() alone does not know the lines: it
+ * creates the default backend, and warns once per process that the tuning
+ * was skipped.
+ *
+ * The methods of this class are thread safe.
+ *
+ * \ingroup Ultrasound
+ */
+class BackendRegistry
+{
+public:
+  /** Implementations of the 1D FFT filters. */
+  enum BackendType
+  {
+    DEFAULT = 0,
+    VNL,
+    FFTW,
+    NATIVE,
+    OPENCL,
+    AUTO_TUNE
+  };
+
+  /** Kind of transform, a part of the auto-tuning key. */
+  enum TransformKind
+  {
+    REAL_TO_COMPLEX = 0,
+    COMPLEX_TO_REAL,
+    COMPLEX_TO_COMPLEX
+  };
+
+  /** Set/Get the backend of the filters created by the New() methods. The
+   * first Get, when there was no Set before, reads the
+   * ITKUltrasound_FFT1D_BACKEND environment variable. */
+  static void
+  SetBackend(BackendType backend)
+  {
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    state.m_Backend = backend;
+    state.m_BackendInitialized = true;
+  }
+  static BackendType
+  GetBackend()
+  {
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    if (!state.m_BackendInitialized)
+    {
+      state.m_Backend = DEFAULT;
+      const char * name = std::getenv("ITKUltrasound_FFT1D_BACKEND");
+      if (name != nullptr && !GetBackendFromName(name, state.m_Backend))
+      {
+        itkGenericOutputMacro("Unknown ITKUltrasound_FFT1D_BACKEND " << name << ", using the default backend");
+      }
+      state.m_BackendInitialized = true;
+    }
+    return state.m_Backend;
+  }
+
+  /** Backend of the New() methods that do not know the lines to transform:
+   * GetBackend(), or DEFAULT for AUTO_TUNE, with a warning the first time. */
+  static BackendType
+  GetUntunedBackend()
+  {
+    const BackendType backend = GetBackend();
+    if (backend != AUTO_TUNE)
+    {
+      return backend;
+    }
+    State & state = GetState();
+    bool    warn = false;
+    {
+      std::lock_guard<std::mutex> lock(state.m_Mutex);
+      warn = !state.m_UntunedWarningIssued;
+      state.m_UntunedWarningIssued = true;
+    }
+    if (warn)
+    {
+      itkGenericOutputMacro("The auto-tuned FFT1D backend needs the size of the lines: the filters created with New(), "
+                            "without it, use the default backend");
+    }
+    return DEFAULT;
+  }
+
+  /** Forget the backend set with SetBackend(): the next GetBackend() reads the
+   * environment variable again. */
+  static void
+  ResetBackend()
+  {
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    state.m_BackendInitialized = false;
+  }
+
+  /** Backend of a name of the environment variable, not case sensitive.
+   * Returns false, and leaves backend unchanged, for an unknown name. */
+  static bool
+  GetBackendFromName(const std::string & name, BackendType & backend)
+  {
+    std::string lowerName(name);
+    std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), [](unsigned char c) {
+      return static_cast<char>(std::tolower(c));
+    });
+    for (int candidate = DEFAULT; candidate <= AUTO_TUNE; ++candidate)
+    {
+      if (lowerName == GetBackendName(static_cast<BackendType>(candidate)))
+      {
+        backend = static_cast<BackendType>(candidate);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /** Name of a backend, as used in the environment variable. */
+  static const char *
+  GetBackendName(BackendType backend)
+  {
+    switch (backend)
+    {
+      case VNL:
+        return "vnl";
+      case FFTW:
+        return "fftw";
+      case NATIVE:
+        return "native";
+      case OPENCL:
+        return "opencl";
+      case AUTO_TUNE:
+        return "auto";
+      default:
+        return "default";
+    }
+  }
+
+  /** Backend selected by auto-tuning for lines of this size, along this
+   * direction, and precision (TReal is float or double). On the first call for a key, timeBackend is
+   * called with each of VNL, FFTW, NATIVE and OPENCL and returns the time it
+   * took in seconds, or a negative value when the backend is not available;
+   * the fastest backend is cached. The benchmarks of different keys do not
+   * run concurrently, so that they do not disturb each other. */
+  template <typename TReal, typename TTimeFunction>
+  static BackendType
+  GetTunedBackend(TransformKind kind,
+                  SizeValueType lineSize,
+                  SizeValueType numberOfLines,
+                  unsigned int  direction,
+                  TTimeFunction timeBackend)
+  {
+    const TuningKey key(kind, lineSize, numberOfLines, direction, sizeof(TReal));
+    State &         state = GetState();
+    {
+      std::lock_guard<std::mutex> lock(state.m_Mutex);
+      auto                        found = state.m_TunedBackends.find(key);
+      if (found != state.m_TunedBackends.end())
+      {
+        return found->second;
+      }
+    }
+
+    std::lock_guard<std::mutex> tuningLock(state.m_TuningMutex);
+    {
+      // tuned by another thread while this one was waiting
+      std::lock_guard<std::mutex> lock(state.m_Mutex);
+      auto                        found = state.m_TunedBackends.find(key);
+      if (found != state.m_TunedBackends.end())
+      {
+        return found->second;
+      }
+    }
+    BackendType fastest = DEFAULT;
+    double      fastestTime = std::numeric_limits<double>::max();
+    for (BackendType candidate : { VNL, FFTW, NATIVE, OPENCL })
+    {
+      const double time = timeBackend(candidate);
+      if (time >= 0.0 && time < fastestTime)
+      {
+        fastest = candidate;
+        fastestTime = time;
+      }
+    }
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    state.m_TunedBackends[key] = fastest;
+    return fastest;
+  }
+
+  /** Number of (transform kind, line size, number of lines, direction,
+   * precision) combinations tuned so far. */
+  static SizeValueType
+  GetNumberOfTunedSizes()
+  {
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    return state.m_TunedBackends.size();
+  }
+
+  /** Forget the auto-tuning results. */
+  static void
+  ClearTunedBackends()
+  {
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    state.m_TunedBackends.clear();
+  }
+
+  /** Shortest wall clock time, in seconds, of a few updates of filter on
+   * input, after a first update that creates the plans and buffers. Returns a
+   * negative value when the filter throws. */
+  template <typename TFilter, typename TImage>
+  static double
+  TimeFilter(TFilter * filter, const TImage * input, unsigned int numberOfRuns = 3)
+  {
+    using ClockType = std::chrono::steady_clock;
+    filter->SetInput(input);
+    double shortest = std::numeric_limits<double>::max();
+    try
+    {
+      filter->Update();
+      for (unsigned int run = 0; run < numberOfRuns; ++run)
+      {
+        filter->Modified();
+        const ClockType::time_point start = ClockType::now();
+        filter->Update();
+        const std::chrono::duration<double> elapsed = ClockType::now() - start;
+        shortest = std::min(shortest, elapsed.count());
+      }
+    }
+    catch (ExceptionObject &)
+    {
+      return -1.0;
+    }
+    return shortest;
+  }
+
+  /** Image of numberOfLines lines of lineSize pixels along direction, to
+   * time the backends on. The lines are stacked along the first dimension,
+   * or the second one when direction is the first, so that they are
+   * contiguous in memory only when direction is the first dimension, as in
+   * the images transformed along it. */
+  template <typename TImage>
+  static typename TImage::Pointer
+  MakeTuningImage(SizeValueType lineSize, SizeValueType numberOfLines, unsigned int direction = 0)
+  {
+    typename TImage::SizeType size;
+    size.Fill(1);
+    direction = std::min(direction, TImage::ImageDimension - 1);
+    size[direction] = lineSize;
+    if (TImage::ImageDimension > 1)
+    {
+      size[direction == 0 ? 1 : 0] = std::max(numberOfLines, SizeValueType{ 1 });
+    }
+    typename TImage::Pointer image = TImage::New();
+    image->SetRegions(size);
+    image->Allocate();
+    image->FillBuffer(typename TImage::PixelType(1));
+    return image;
+  }
+
+private:
+  using TuningKey = std::tuple<TransformKind, SizeValueType, SizeValueType, unsigned int, SizeValueType>;
+
+  struct State
+  {
+    std::mutex                       m_Mutex;
+    std::mutex                       m_TuningMutex;
+    BackendType                      m_Backend{ DEFAULT };
+    bool                             m_BackendInitialized{ false };
+    bool                             m_UntunedWarningIssued{ false };
+    std::map<TuningKey, BackendType> m_TunedBackends;
+  };
+
+  static State &
+  GetState()
+  {
+    static State state;
+    return state;
+  }
+};
+
+} // end namespace fft1d
+} // end namespace itk
+
+#endif // itkFFT1DBackendRegistry_h
@@ -0,0 +1,255 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFFT1DFixedLengthKernels_h
+#define itkFFT1DFixedLengthKernels_h
+
+#include "itkIntTypes.h"
+#include "itkMath.h"
+#include "itkNativeFFTSIMD.h"
+
+#include <cmath>
+#include <complex>
+
+namespace itk
+{
+namespace fft1d
+{
+
+/** \class FixedLengthTwiddles
+ * \brief Twiddle factors w^k, w^2k and w^3k, k < VLength / 4, of the last
+ * radix 4 step of a FixedLengthKernel, with w = e^{-2 pi i / VLength}.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TReal, unsigned int VLength>
+struct FixedLengthTwiddles
+{
+  static constexpr unsigned int Quarter = VLength / 4;
+
+  std::complex<TReal> Forward[3][Quarter];
+  std::complex<TReal> Backward[3][Quarter];
+
+  static const FixedLengthTwiddles &
+  GetInstance()
+  {
+    static const FixedLengthTwiddles instance;
+    return instance;
+  }
+
+private:
+  FixedLengthTwiddles()
+  {
+    for (unsigned int r = 1; r <= 3; ++r)
+    {
+      for (unsigned int k = 0; k < Quarter; ++k)
+      {
+        const double angle = -2.0 * Math::pi * static_cast<double>(r * k) / static_cast<double>(VLength);
+        Forward[r - 1][k] = std::complex<TReal>(static_cast<TReal>(std::cos(angle)), static_cast<TReal>(std::sin(angle)));
+        Backward[r - 1][k] = std::conj(Forward[r - 1][k]);
+      }
+    }
+  }
+};
+
+
+/** \class FixedLengthKernel
+ * \brief FFT of a length known at compile time.
+ *
+ * The transform is a recursive radix 4 decimation in time: the four sub
+ * transforms of length VLength / 4 read every fourth input value and are
+ * instantiated for their own length, down to the hand written transforms of
+ * length 4 and 2. As every length is a compile time constant, the compiler
+ * unrolls the whole recursion and all the loops of small lengths, and the
+ * radix 4 steps run with the complex packs of itkNativeFFTSIMD.h once a
+ * quarter holds at least a full pack.
+ *
+ * VLength must be a power of two. VInverse selects the unnormalized backward
+ * transform. The input, read with the given stride, and the output must not
+ * overlap.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TReal, unsigned int VLength, bool VInverse>
+struct FixedLengthKernel
+{
+  using ComplexType = std::complex<TReal>;
+  static constexpr unsigned int Quarter = VLength / 4;
+
+  static void
+  Apply(const ComplexType * input, SizeValueType stride, ComplexType * output)
+  {
+    using SubKernelType = FixedLengthKernel<TReal, Quarter, VInverse>;
+    for (unsigned int r = 0; r < 4; ++r)
+    {
+      SubKernelType::Apply(input + r * stride, 4 * stride, output + r * Quarter);
+    }
+    using VectorPackType = typename WidestComplexPack<TReal>::Type;
+    if (Quarter % VectorPackType::Width == 0)
+    {
+      Combine<VectorPackType>(output);
+    }
+    else
+    {
+      Combine<ScalarComplexPack<TReal>>(output);
+    }
+  }
+
+private:
+  template <typename TPack>
+  static void
+  Combine(ComplexType * output)
+  {
+    const FixedLengthTwiddles<TReal, VLength> & twiddles = FixedLengthTwiddles<TReal, VLength>::GetInstance();
+    const ComplexType(&w)[3][Quarter] = VInverse ? twiddles.Backward : twiddles.Forward;
+    auto * y = reinterpret_cast<TReal *>(output);
+    for (unsigned int k = 0; k < Quarter; k += TPack::Width)
+    {
+      const TPack a0 = TPack::Load(y + 2 * k);
+      const TPack a1 = TPack::Load(y + 2 * (k + Quarter)).Multiply(TPack::Load(reinterpret_cast<const TReal *>(w[0] + k)));
+      const TPack a2 =
+        TPack::Load(y + 2 * (k + 2 * Quarter)).Multiply(TPack::Load(reinterpret_cast<const TReal *>(w[1] + k)));
+      const TPack a3 =
+        TPack::Load(y + 2 * (k + 3 * Quarter)).Multiply(TPack::Load(reinterpret_cast<const TReal *>(w[2] + k)));
+      const TPack t0 = a0 + a2;
+      const TPack t1 = a0 - a2;
+      const TPack t2 = a1 + a3;
+      const TPack t3 = VInverse ? (a1 - a3).MultiplyByI() : (a1 - a3).MultiplyByMinusI();
+      (t0 + t2).Store(y + 2 * k);
+      (t1 + t3).Store(y + 2 * (k + Quarter));
+      (t0 - t2).Store(y + 2 * (k + 2 * Quarter));
+      (t1 - t3).Store(y + 2 * (k + 3 * Quarter));
+    }
+  }
+};
+
+template <typename TReal, bool VInverse>
+struct FixedLengthKernel<TReal, 4, VInverse>
+{
+  using ComplexType = std::complex<TReal>;
+
+  static void
+  Apply(const ComplexType * input, SizeValueType stride, ComplexType * output)
+  {
+    const ComplexType t0 = input[0] + input[2 * stride];
+    const ComplexType t1 = input[0] - input[2 * stride];
+    const ComplexType t2 = input[stride] + input[3 * stride];
+    const ComplexType d = input[stride] - input[3 * stride];
+    // -i d for the forward transform
+    const ComplexType t3 = VInverse ? ComplexType(-d.imag(), d.real()) : ComplexType(d.imag(), -d.real());
+    output[0] = t0 + t2;
+    output[1] = t1 + t3;
+    output[2] = t0 - t2;
+    output[3] = t1 - t3;
+  }
+};
+
+template <typename TReal, bool VInverse>
+struct FixedLengthKernel<TReal, 2, VInverse>
+{
+  using ComplexType = std::complex<TReal>;
+
+  static void
+  Apply(const ComplexType * input, SizeValueType stride, ComplexType * output)
+  {
+    output[0] = input[0] + input[stride];
+    output[1] = input[0] - input[stride];
+  }
+};
+
+
+/** \class FixedLengthFFT
+ * \brief Runtime selection of the FixedLengthKernel instantiated for the
+ * power of two lengths from 8 to 512.
+ *
+ * These are the window sizes of Spectra1DImageFilter and the short lines of
+ * the 1D FFT filters, where the generic transforms spend a large part of
+ * their time on loop and twiddle bookkeeping. NativeFFT uses these kernels
+ * for the lengths they support.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TReal>
+class FixedLengthFFT
+{
+public:
+  using ComplexType = std::complex<TReal>;
+
+  static constexpr SizeValueType MinimumLength = 8;
+  static constexpr SizeValueType MaximumLength = 512;
+
+  /** Whether there is a kernel for this length. */
+  static bool
+  IsLengthSupported(SizeValueType length)
+  {
+    return length >= MinimumLength && length <= MaximumLength && (length & (length - 1)) == 0;
+  }
+
+  /** Forward transform, with the e^{-2 pi i jk/N} kernel. input and output
+   * must not overlap. Returns false, without transforming, when there is no
+   * kernel for this length. */
+  static bool
+  Forward(SizeValueType length, const ComplexType * input, ComplexType * output)
+  {
+    return Dispatch<false>(length, input, output);
+  }
+
+  /** Unnormalized backward transform, with the e^{+2 pi i jk/N} kernel. */
+  static bool
+  Backward(SizeValueType length, const ComplexType * input, ComplexType * output)
+  {
+    return Dispatch<true>(length, input, output);
+  }
+
+private:
+  template <bool VInverse>
+  static bool
+  Dispatch(SizeValueType length, const ComplexType * input, ComplexType * output)
+  {
+    switch (length)
+    {
+      case 8:
+        FixedLengthKernel<TReal, 8, VInverse>::Apply(input, 1, output);
+        return true;
+      case 16:
+        FixedLengthKernel<TReal, 16, VInverse>::Apply(input, 1, output);
+        return true;
+      case 32:
+        FixedLengthKernel<TReal, 32, VInverse>::Apply(input, 1, output);
+        return true;
+      case 64:
+        FixedLengthKernel<TReal, 64, VInverse>::Apply(input, 1, output);
+        return true;
+      case 128:
+        FixedLengthKernel<TReal, 128, VInverse>::Apply(input, 1, output);
+        return true;
+      case 256:
+        FixedLengthKernel<TReal, 256, VInverse>::Apply(input, 1, output);
+        return true;
+      case 512:
+        FixedLengthKernel<TReal, 512, VInverse>::Apply(input, 1, output);
+        return true;
+      default:
+        return false;
+    }
+  }
+};
+
+} // end namespace fft1d
+} // end namespace itk
+
+#endif // itkFFT1DFixedLengthKernels_h
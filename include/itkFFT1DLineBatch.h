@@ -0,0 +1,273 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFFT1DLineBatch_h
+#define itkFFT1DLineBatch_h
+
+#include "itkIntTypes.h"
+
+#include <algorithm>
+
+namespace itk
+{
+namespace fft1d
+{
+
+/** Return a pointer to the first pixel of a batch of lines when the lines can
+ * be addressed in place as a single block: every line runs along the fastest
+ * varying image dimension (direction 0) and line i starts exactly
+ * i * lineSize pixels after the first one in the image buffer. Return nullptr
+ * otherwise, in which case the lines have to be gathered into a contiguous
+ * buffer.
+ *
+ * TLineStartContainer holds the index of the first pixel of each line.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TImage, typename TLineStartContainer>
+auto
+ContiguousLines(TImage *                    image,
+                const TLineStartContainer & lineStarts,
+                const SizeValueType         lineSize,
+                const unsigned int          direction) -> decltype(image->GetBufferPointer())
+{
+  if (direction != 0 || lineStarts.empty())
+  {
+    return nullptr;
+  }
+  const OffsetValueType firstLineOffset = image->ComputeOffset(lineStarts[0]);
+  for (SizeValueType line = 1; line < lineStarts.size(); ++line)
+  {
+    if (image->ComputeOffset(lineStarts[line]) != firstLineOffset + static_cast<OffsetValueType>(line * lineSize))
+    {
+      return nullptr;
+    }
+  }
+  return image->GetBufferPointer() + firstLineOffset;
+}
+
+
+/** Maximum number of adjacent lines in the tiles of ForEachLineTile. A row of
+ * a tile of 16 complex double pixels spans four cache lines. */
+constexpr SizeValueType MaximumLineTileSize = 16;
+
+
+/** Dimension along which the lines of a tile are adjacent: the fastest
+ * varying dimension other than the direction of the lines. */
+inline unsigned int
+GetLineTileDimension(const unsigned int direction)
+{
+  return direction == 0 ? 1 : 0;
+}
+
+
+/** Split the lines along direction in region into tiles of at most
+ * maximumTileSize lines that are adjacent along GetLineTileDimension(), and
+ * call tileFunction(tileStart, numberOfLines) for each tile, where tileStart
+ * is the index of the first pixel of the first line of the tile.
+ *
+ * The 1D FFT filters gather, transform and scatter the lines of their output
+ * region a tile at a time: along a strided direction, the lines of a tile
+ * are then read and written a tile row at a time, see GatherLineTile, and the
+ * FFTW filters transform a tile as a batch. What only describes the
+ * transform, the plans, the NativeFFT1D objects or the analytic signal
+ * kernel, is not modified by the transforms and is shared by all the work
+ * units; each work unit has its own tile buffers.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TRegion, typename TTileFunction>
+void
+ForEachLineTile(const TRegion &     region,
+                const unsigned int  direction,
+                const SizeValueType maximumTileSize,
+                TTileFunction       tileFunction)
+{
+  constexpr unsigned int              ImageDimension = TRegion::ImageDimension;
+  const unsigned int                  tileDimension = GetLineTileDimension(direction);
+  const typename TRegion::IndexType & start = region.GetIndex();
+  const typename TRegion::SizeType &  size = region.GetSize();
+  if (region.GetNumberOfPixels() == 0)
+  {
+    return;
+  }
+
+  typename TRegion::IndexType tileStart = start;
+  while (true)
+  {
+    if (tileDimension < ImageDimension)
+    {
+      for (SizeValueType line = 0; line < size[tileDimension]; line += maximumTileSize)
+      {
+        tileStart[tileDimension] = start[tileDimension] + static_cast<IndexValueType>(line);
+        tileFunction(tileStart, std::min(maximumTileSize, size[tileDimension] - line));
+      }
+      tileStart[tileDimension] = start[tileDimension];
+    }
+    else
+    {
+      tileFunction(tileStart, SizeValueType{ 1 });
+    }
+
+    // next row of tiles, along the other dimensions
+    unsigned int dimension = 0;
+    for (; dimension < ImageDimension; ++dimension)
+    {
+      if (dimension == direction || dimension == tileDimension)
+      {
+        continue;
+      }
+      if (++tileStart[dimension] < start[dimension] + static_cast<IndexValueType>(size[dimension]))
+      {
+        break;
+      }
+      tileStart[dimension] = start[dimension];
+    }
+    if (dimension == ImageDimension)
+    {
+      return;
+    }
+  }
+}
+
+
+/** Copy numberOfLines lines of lineSize pixels along direction, adjacent
+ * along GetLineTileDimension() and starting at tileStart, into buffer, line
+ * after line, bufferLineStride values apart. When the lines are strided in
+ * memory, the tile is read a row at a time: the pixels of a row are next to
+ * each other in the image buffer, so each cache line brought in serves all
+ * the lines of the tile instead of a single one.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TImage, typename TValue>
+void
+GatherLineTile(const TImage *                     image,
+               const typename TImage::IndexType & tileStart,
+               const unsigned int                 direction,
+               const SizeValueType                lineSize,
+               const SizeValueType                numberOfLines,
+               TValue *                           buffer,
+               const SizeValueType                bufferLineStride)
+{
+  const unsigned int      tileDimension = GetLineTileDimension(direction);
+  const OffsetValueType * offsetTable = image->GetOffsetTable();
+  const OffsetValueType   lineStride = offsetTable[direction];
+  const OffsetValueType   tileStride = tileDimension < TImage::ImageDimension ? offsetTable[tileDimension] : 0;
+  const auto *            pixels = image->GetBufferPointer() + image->ComputeOffset(tileStart);
+
+  if (lineStride < tileStride)
+  {
+    for (SizeValueType line = 0; line < numberOfLines; ++line)
+    {
+      const auto * linePixels = pixels + line * tileStride;
+      TValue *     lineBuffer = buffer + line * bufferLineStride;
+      for (SizeValueType k = 0; k < lineSize; ++k)
+      {
+        lineBuffer[k] = static_cast<TValue>(linePixels[k * lineStride]);
+      }
+    }
+    return;
+  }
+  for (SizeValueType k = 0; k < lineSize; ++k)
+  {
+    const auto * rowPixels = pixels + k * lineStride;
+    for (SizeValueType line = 0; line < numberOfLines; ++line)
+    {
+      buffer[line * bufferLineStride + k] = static_cast<TValue>(rowPixels[line * tileStride]);
+    }
+  }
+}
+
+
+/** GatherLineTile into lines stored back to back in buffer. */
+template <typename TImage, typename TValue>
+void
+GatherLineTile(const TImage *                     image,
+               const typename TImage::IndexType & tileStart,
+               const unsigned int                 direction,
+               const SizeValueType                lineSize,
+               const SizeValueType                numberOfLines,
+               TValue *                           buffer)
+{
+  GatherLineTile(image, tileStart, direction, lineSize, numberOfLines, buffer, lineSize);
+}
+
+
+/** Copy the lines of a tile from buffer, bufferLineStride values apart, back
+ * into the image, in the same blocked order as GatherLineTile.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TImage, typename TValue>
+void
+ScatterLineTile(TImage *                           image,
+                const typename TImage::IndexType & tileStart,
+                const unsigned int                 direction,
+                const SizeValueType                lineSize,
+                const SizeValueType                numberOfLines,
+                const TValue *                     buffer,
+                const SizeValueType                bufferLineStride)
+{
+  using PixelType = typename TImage::PixelType;
+  const unsigned int      tileDimension = GetLineTileDimension(direction);
+  const OffsetValueType * offsetTable = image->GetOffsetTable();
+  const OffsetValueType   lineStride = offsetTable[direction];
+  const OffsetValueType   tileStride = tileDimension < TImage::ImageDimension ? offsetTable[tileDimension] : 0;
+  PixelType *             pixels = image->GetBufferPointer() + image->ComputeOffset(tileStart);
+
+  if (lineStride < tileStride)
+  {
+    for (SizeValueType line = 0; line < numberOfLines; ++line)
+    {
+      PixelType *    linePixels = pixels + line * tileStride;
+      const TValue * lineBuffer = buffer + line * bufferLineStride;
+      for (SizeValueType k = 0; k < lineSize; ++k)
+      {
+        linePixels[k * lineStride] = static_cast<PixelType>(lineBuffer[k]);
+      }
+    }
+    return;
+  }
+  for (SizeValueType k = 0; k < lineSize; ++k)
+  {
+    PixelType * rowPixels = pixels + k * lineStride;
+    for (SizeValueType line = 0; line < numberOfLines; ++line)
+    {
+      rowPixels[line * tileStride] = static_cast<PixelType>(buffer[line * bufferLineStride + k]);
+    }
+  }
+}
+
+
+/** ScatterLineTile from lines stored back to back in buffer. */
+template <typename TImage, typename TValue>
+void
+ScatterLineTile(TImage *                           image,
+                const typename TImage::IndexType & tileStart,
+                const unsigned int                 direction,
+                const SizeValueType                lineSize,
+                const SizeValueType                numberOfLines,
+                const TValue *                     buffer)
+{
+  ScatterLineTile(image, tileStart, direction, lineSize, numberOfLines, buffer, lineSize);
+}
+
+} // end namespace fft1d
+} // end namespace itk
+
+#endif // itkFFT1DLineBatch_h
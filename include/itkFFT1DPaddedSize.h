@@ -0,0 +1,185 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFFT1DPaddedSize_h
+#define itkFFT1DPaddedSize_h
+
+#include "itkIntTypes.h"
+#include "itkMath.h"
+#include "itkNativeFFT1D.h"
+
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace itk
+{
+namespace fft1d
+{
+
+/** \class PaddedSize
+ * \brief Size to zero pad a signal to before its FFT.
+ *
+ * ComputeSmallestSize() gives the smallest size with no prime factor greater
+ * than the greatest prime factor a backend transforms efficiently, see
+ * Forward1DFFTImageFilter::GetSizeGreatestPrimeFactor(): a 2100 value line is
+ * padded to 2160 = 2^4 3^3 5 for a backend that supports the factors up to 5,
+ * rather than to 4096.
+ *
+ * ComputeFastestSize() rather picks, among those sizes up to the next power of
+ * two, the one with the shortest transform time in a table of costs measured
+ * with the native kernels of NativeFFT: the radix 3 and 5 stages cost more
+ * than the radix 2 ones, so a slightly larger size may be faster. A size is
+ * measured the first time it is a candidate, and its cost is kept for the
+ * life of the process, so a process always picks the same size for the same
+ * arguments, but another run or machine may pick another one.
+ *
+ * The methods of this class are thread safe.
+ *
+ * \ingroup Ultrasound
+ */
+class PaddedSize
+{
+public:
+  /** Smallest size not less than size with no prime factor greater than
+   * greatestPrimeFactor. A greatestPrimeFactor of 1 only makes the size even,
+   * and a greatestPrimeFactor of 0 leaves it unchanged. */
+  static SizeValueType
+  ComputeSmallestSize(SizeValueType size, SizeValueType greatestPrimeFactor)
+  {
+    if (greatestPrimeFactor == 0 || size == 0)
+    {
+      return size;
+    }
+    if (greatestPrimeFactor == 1)
+    {
+      return size + size % 2;
+    }
+    while (Math::GreatestPrimeFactor(size) > greatestPrimeFactor)
+    {
+      ++size;
+    }
+    return size;
+  }
+
+  /** Size of the shortest measured transform time among the sizes from size
+   * to the next power of two with no prime factor greater than
+   * greatestPrimeFactor. */
+  static SizeValueType
+  ComputeFastestSize(SizeValueType size, SizeValueType greatestPrimeFactor)
+  {
+    if (greatestPrimeFactor < 2 || size < 2)
+    {
+      return ComputeSmallestSize(size, greatestPrimeFactor);
+    }
+    SizeValueType powerOfTwo = 1;
+    while (powerOfTwo < size)
+    {
+      powerOfTwo *= 2;
+    }
+    SizeValueType fastestSize = powerOfTwo;
+    double        fastestCost = GetCost(powerOfTwo);
+    // the cost per value grows with the size, so the candidates whose size
+    // times the lowest cost per value measured so far exceeds the fastest
+    // cost are not measured
+    double lowestCostPerValue = fastestCost / powerOfTwo;
+    for (SizeValueType candidate = ComputeSmallestSize(size, greatestPrimeFactor);
+         candidate < powerOfTwo && candidate * lowestCostPerValue < fastestCost;
+         candidate = ComputeSmallestSize(candidate + 1, greatestPrimeFactor))
+    {
+      const double cost = GetCost(candidate);
+      lowestCostPerValue = std::min(lowestCostPerValue, cost / candidate);
+      if (cost < fastestCost)
+      {
+        fastestSize = candidate;
+        fastestCost = cost;
+      }
+    }
+    return fastestSize;
+  }
+
+  /** Measured time of a single precision complex transform of size values
+   * with the native kernels, in seconds. */
+  static double
+  GetCost(SizeValueType size)
+  {
+    CostTable &                 table = GetCostTable();
+    std::lock_guard<std::mutex> lock(table.m_Mutex);
+    const auto                  found = table.m_Costs.find(size);
+    if (found != table.m_Costs.end())
+    {
+      return found->second;
+    }
+    const double cost = MeasureCost(size);
+    table.m_Costs.emplace(size, cost);
+    return cost;
+  }
+
+private:
+  struct CostTable
+  {
+    std::mutex                      m_Mutex;
+    std::map<SizeValueType, double> m_Costs;
+  };
+
+  static CostTable &
+  GetCostTable()
+  {
+    static CostTable table;
+    return table;
+  }
+
+  /** Shortest time of a transform in a few rounds of enough transforms to
+   * last about 50 microseconds each, after a first round that warms up the
+   * buffers. */
+  static double
+  MeasureCost(SizeValueType size)
+  {
+    using ClockType = std::chrono::steady_clock;
+    using ComplexType = std::complex<float>;
+    const NativeFFT<float>   fft(size);
+    std::vector<ComplexType> input(size, ComplexType(1.0f, 0.5f));
+    std::vector<ComplexType> output(size);
+    std::vector<ComplexType> work(fft.GetWorkSize());
+    const SizeValueType      numberOfTransforms = std::max(SizeValueType{ 1 }, SizeValueType{ 8192 } / size);
+
+    double shortest = std::numeric_limits<double>::max();
+    for (unsigned int round = 0; round < 4; ++round)
+    {
+      const ClockType::time_point start = ClockType::now();
+      for (SizeValueType transform = 0; transform < numberOfTransforms; ++transform)
+      {
+        fft.Forward(input.data(), output.data(), work.data());
+      }
+      const std::chrono::duration<double> elapsed = ClockType::now() - start;
+      if (round > 0)
+      {
+        shortest = std::min(shortest, elapsed.count() / numberOfTransforms);
+      }
+    }
+    return shortest;
+  }
+};
+
+} // end namespace fft1d
+} // end namespace itk
+
+#endif // itkFFT1DPaddedSize_h
@@ -0,0 +1,372 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFFT1DScratchArena_h
+#define itkFFT1DScratchArena_h
+
+#include "itkIntTypes.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+namespace fft1d
+{
+
+/** \class ScratchArena
+ * \brief Aligned scratch memory of the 1D FFT filters, recycled through free
+ * lists.
+ *
+ * The blocks are aligned on Alignment bytes, enough for the SIMD codelets of
+ * FFTW, whose plans are only used on buffers of the alignment they were made
+ * for, and for the widest packs of the native transforms. The block sizes are
+ * rounded up to a power of two. A released block goes to a free list of the
+ * releasing thread, which keeps up to MaximumNumberOfCachedBlocks blocks of a
+ * size, and to a process wide free list beyond that or when the thread exits.
+ * The process wide list keeps up to MaximumNumberOfSharedBlocks blocks of a
+ * size, and the blocks beyond are freed, so that the threads that come and
+ * go do not pile up memory. A thread takes its blocks from its own list
+ * first, then from the process wide one, and only allocates when both are
+ * empty.
+ *
+ * Once the filters have run on lines of a size, their work units get their
+ * buffers from the free lists, also after a change of line size within the
+ * same power of two, and GetNumberOfAllocations() stops increasing.
+ *
+ * The methods of this class are thread safe.
+ *
+ * \ingroup Ultrasound
+ */
+class ScratchArena
+{
+public:
+  /** Alignment of the blocks, in bytes. */
+  static constexpr SizeValueType Alignment = 64;
+
+  /** Number of released blocks of a size kept by each thread. */
+  static constexpr SizeValueType MaximumNumberOfCachedBlocks = 8;
+
+  /** Number of released blocks of a size kept in the process wide free list. */
+  static constexpr SizeValueType MaximumNumberOfSharedBlocks = 64;
+
+  /** Get a block of at least numberOfBytes bytes, whose actual size is
+   * returned in capacity and must be given back to Release(). Throws
+   * std::bad_alloc when the memory cannot be allocated. */
+  static void *
+  Acquire(SizeValueType numberOfBytes, SizeValueType & capacity)
+  {
+    const unsigned int sizeClass = GetSizeClass(numberOfBytes);
+    capacity = SizeValueType{ 1 } << sizeClass;
+
+    std::vector<void *> & threadBlocks = GetThreadCache().m_Blocks[sizeClass];
+    if (!threadBlocks.empty())
+    {
+      void * block = threadBlocks.back();
+      threadBlocks.pop_back();
+      ++GetState().m_NumberOfReuses;
+      return block;
+    }
+    {
+      State &                     state = GetState();
+      std::lock_guard<std::mutex> lock(state.m_Mutex);
+      std::vector<void *> &       blocks = state.m_Blocks[sizeClass];
+      if (!blocks.empty())
+      {
+        void * block = blocks.back();
+        blocks.pop_back();
+        ++state.m_NumberOfReuses;
+        return block;
+      }
+    }
+    return AllocateAligned(capacity);
+  }
+
+  /** Give back a block obtained from Acquire(). */
+  static void
+  Release(void * block, SizeValueType capacity)
+  {
+    if (block == nullptr)
+    {
+      return;
+    }
+    const unsigned int    sizeClass = GetSizeClass(capacity);
+    std::vector<void *> & threadBlocks = GetThreadCache().m_Blocks[sizeClass];
+    if (threadBlocks.size() < MaximumNumberOfCachedBlocks)
+    {
+      threadBlocks.push_back(block);
+      return;
+    }
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    std::vector<void *> &       blocks = state.m_Blocks[sizeClass];
+    if (blocks.size() < MaximumNumberOfSharedBlocks)
+    {
+      blocks.push_back(block);
+      return;
+    }
+    FreeBlock(block, sizeClass);
+  }
+
+  /** Number of blocks allocated from the system since the last
+   * ResetCounters(). */
+  static SizeValueType
+  GetNumberOfAllocations()
+  {
+    return GetState().m_NumberOfAllocations;
+  }
+
+  /** Number of blocks taken from the free lists since the last
+   * ResetCounters(). */
+  static SizeValueType
+  GetNumberOfReuses()
+  {
+    return GetState().m_NumberOfReuses;
+  }
+
+  /** Number of bytes allocated from the system and not freed yet, in use or
+   * on the free lists. */
+  static SizeValueType
+  GetNumberOfAllocatedBytes()
+  {
+    return GetState().m_NumberOfAllocatedBytes;
+  }
+
+  static void
+  ResetCounters()
+  {
+    GetState().m_NumberOfAllocations = 0;
+    GetState().m_NumberOfReuses = 0;
+  }
+
+  /** Free the blocks of the free lists of the calling thread and of the
+   * process wide ones. */
+  static void
+  FreeCachedBlocks()
+  {
+    FreeBlocks(GetThreadCache());
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    FreeBlocks(state);
+  }
+
+private:
+  static constexpr unsigned int NumberOfSizeClasses = 8 * sizeof(SizeValueType);
+
+  struct BlockLists
+  {
+    std::vector<void *> m_Blocks[NumberOfSizeClasses];
+  };
+
+  struct State : BlockLists
+  {
+    std::mutex                 m_Mutex;
+    std::atomic<SizeValueType> m_NumberOfAllocations{ 0 };
+    std::atomic<SizeValueType> m_NumberOfReuses{ 0 };
+    std::atomic<SizeValueType> m_NumberOfAllocatedBytes{ 0 };
+  };
+
+  /** Free list of a thread, handed over to the process wide one, up to its
+   * capacity, when the thread exits. */
+  struct ThreadCache : BlockLists
+  {
+    ~ThreadCache()
+    {
+      State &                     state = GetState();
+      std::lock_guard<std::mutex> lock(state.m_Mutex);
+      for (unsigned int sizeClass = 0; sizeClass < NumberOfSizeClasses; ++sizeClass)
+      {
+        std::vector<void *> & blocks = state.m_Blocks[sizeClass];
+        for (void * block : m_Blocks[sizeClass])
+        {
+          if (blocks.size() < MaximumNumberOfSharedBlocks)
+          {
+            blocks.push_back(block);
+          }
+          else
+          {
+            FreeBlock(block, sizeClass);
+          }
+        }
+      }
+    }
+  };
+
+  /** The state is never destroyed, as the threads of the ITK pool may exit
+   * after the static objects. */
+  static State &
+  GetState()
+  {
+    static State * state = new State;
+    return *state;
+  }
+
+  static ThreadCache &
+  GetThreadCache()
+  {
+    static thread_local ThreadCache cache;
+    return cache;
+  }
+
+  /** Base 2 logarithm of the capacity of a block of numberOfBytes bytes. */
+  static unsigned int
+  GetSizeClass(SizeValueType numberOfBytes)
+  {
+    unsigned int sizeClass = 0;
+    while ((SizeValueType{ 1 } << sizeClass) < numberOfBytes || (SizeValueType{ 1 } << sizeClass) < Alignment)
+    {
+      ++sizeClass;
+    }
+    return sizeClass;
+  }
+
+  /** The address returned by malloc is stored just before the aligned
+   * block. */
+  static void *
+  AllocateAligned(SizeValueType capacity)
+  {
+    void * memory = std::malloc(capacity + Alignment);
+    if (memory == nullptr)
+    {
+      throw std::bad_alloc();
+    }
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(memory) + sizeof(void *);
+    void *               block = reinterpret_cast<void *>((address + Alignment - 1) & ~std::uintptr_t{ Alignment - 1 });
+    static_cast<void **>(block)[-1] = memory;
+    ++GetState().m_NumberOfAllocations;
+    GetState().m_NumberOfAllocatedBytes += capacity;
+    return block;
+  }
+
+  static void
+  FreeBlock(void * block, unsigned int sizeClass)
+  {
+    std::free(static_cast<void **>(block)[-1]);
+    GetState().m_NumberOfAllocatedBytes -= SizeValueType{ 1 } << sizeClass;
+  }
+
+  static void
+  FreeBlocks(BlockLists & lists)
+  {
+    for (unsigned int sizeClass = 0; sizeClass < NumberOfSizeClasses; ++sizeClass)
+    {
+      for (void * block : lists.m_Blocks[sizeClass])
+      {
+        FreeBlock(block, sizeClass);
+      }
+      lists.m_Blocks[sizeClass].clear();
+    }
+  }
+};
+
+
+/** \class ScratchBuffer
+ * \brief Array of trivially copyable values in a block of the ScratchArena.
+ *
+ * The values are not initialized. The block goes back to the arena when the
+ * buffer is destroyed, or replaced by a larger one.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename T>
+class ScratchBuffer
+{
+public:
+  static_assert(std::is_trivially_copyable<T>::value, "ScratchBuffer only holds trivially copyable values");
+
+  ScratchBuffer() = default;
+  explicit ScratchBuffer(SizeValueType size) { this->Allocate(size); }
+  ~ScratchBuffer() { ScratchArena::Release(m_Data, m_Capacity); }
+
+  ScratchBuffer(ScratchBuffer && other) noexcept
+    : m_Data(other.m_Data)
+    , m_Size(other.m_Size)
+    , m_Capacity(other.m_Capacity)
+  {
+    other.m_Data = nullptr;
+    other.m_Size = 0;
+    other.m_Capacity = 0;
+  }
+  ScratchBuffer &
+  operator=(ScratchBuffer && other) noexcept
+  {
+    std::swap(m_Data, other.m_Data);
+    std::swap(m_Size, other.m_Size);
+    std::swap(m_Capacity, other.m_Capacity);
+    return *this;
+  }
+  ScratchBuffer(const ScratchBuffer &) = delete;
+  ScratchBuffer &
+  operator=(const ScratchBuffer &) = delete;
+
+  /** Hold size values. The current block is kept when it is large enough, and
+   * the previous values are not preserved otherwise. */
+  void
+  Allocate(SizeValueType size)
+  {
+    if (size * sizeof(T) > m_Capacity)
+    {
+      ScratchArena::Release(m_Data, m_Capacity);
+      m_Data = nullptr;
+      m_Capacity = 0;
+      m_Data = static_cast<T *>(ScratchArena::Acquire(size * sizeof(T), m_Capacity));
+    }
+    m_Size = size;
+  }
+
+  T *
+  data()
+  {
+    return m_Data;
+  }
+  const T *
+  data() const
+  {
+    return m_Data;
+  }
+  SizeValueType
+  size() const
+  {
+    return m_Size;
+  }
+  T &
+  operator[](SizeValueType i)
+  {
+    return m_Data[i];
+  }
+  const T &
+  operator[](SizeValueType i) const
+  {
+    return m_Data[i];
+  }
+
+private:
+  T *           m_Data = nullptr;
+  SizeValueType m_Size = 0;
+  SizeValueType m_Capacity = 0;
+};
+
+} // end namespace fft1d
+} // end namespace itk
+
+#endif // itkFFT1DScratchArena_h
@@ -0,0 +1,109 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFFT1DWorkBufferPool_h
+#define itkFFT1DWorkBufferPool_h
+
+#include "itkIntTypes.h"
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+namespace fft1d
+{
+
+/** \class WorkBufferPool
+ * \brief Pool of the scratch buffers used by the work units of a 1D FFT filter.
+ *
+ * With dynamic multithreading, the work units of a filter are not tied to a
+ * thread id, and there can be many more work units than threads. Each work
+ * unit checks a set of buffers out of the pool for the time it runs and checks
+ * it back in when it is done, so the pool holds about as many buffer sets as
+ * there are work units running concurrently, whatever the number of work
+ * units.
+ *
+ * TBuffers is the type holding one set of buffers.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TBuffers>
+class WorkBufferPool
+{
+public:
+  using BuffersType = TBuffers;
+  using BuffersPointer = std::unique_ptr<BuffersType>;
+
+  WorkBufferPool() = default;
+  WorkBufferPool(const WorkBufferPool &) = delete;
+  WorkBufferPool &
+  operator=(const WorkBufferPool &) = delete;
+
+  /** Take a set of buffers out of the pool. When the pool is empty, a new set
+   * is made with create(), which is called without holding the pool lock. */
+  template <typename TCreateFunction>
+  BuffersPointer
+  CheckOut(TCreateFunction create)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      if (!m_Buffers.empty())
+      {
+        BuffersPointer buffers = std::move(m_Buffers.back());
+        m_Buffers.pop_back();
+        return buffers;
+      }
+    }
+    return create();
+  }
+
+  /** Give a set of buffers back to the pool. */
+  void
+  CheckIn(BuffersPointer buffers)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Buffers.push_back(std::move(buffers));
+  }
+
+  /** Free the buffers held by the pool. */
+  void
+  Clear()
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Buffers.clear();
+  }
+
+  /** Number of buffer sets currently held by the pool. */
+  SizeValueType
+  GetNumberOfBuffers() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Buffers.size();
+  }
+
+private:
+  mutable std::mutex          m_Mutex;
+  std::vector<BuffersPointer> m_Buffers;
+};
+
+} // end namespace fft1d
+} // end namespace itk
+
+#endif // itkFFT1DWorkBufferPool_h
@@ -0,0 +1,359 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFFTW1DPlanCache_h
+#define itkFFTW1DPlanCache_h
+
+#include "itkFFTWCommonExtended.h"
+#include "itkIntTypes.h"
+#include "itkMacro.h"
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+
+#if defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD)
+
+namespace itk
+{
+namespace fftw
+{
+
+/** \class FFTW1DPlanCache
+ * \brief Process-wide cache of the FFTW plans used by the 1D FFT filters.
+ *
+ * The FFTW 1D filters transform lines of the same few lengths over and over,
+ * often from many filter instances at once. Instead of creating and
+ * destroying their own plans, they get them from this cache, which keeps one
+ * plan per transform kind, line length, batch layout, planner flags and
+ * array alignments. There is one cache per precision (TPixel is float or
+ * double).
+ *
+ * All the plans are out-of-place and are meant to be run with the new-array
+ * execute functions of ComplexToComplexProxy (Execute_dft, Execute_dft_r2c,
+ * Execute_dft_c2r) on arrays whose AlignmentOf() matches the alignments of the
+ * key, which is thread safe. The plans are handed out as shared pointers:
+ * when the cache holds more than GetMaximumNumberOfPlans() plans, the least
+ * recently used ones are dropped from the cache and destroyed once the last
+ * filter using them releases them.
+ *
+ * The methods of this class are thread safe.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TPixel>
+class FFTW1DPlanCache
+{
+public:
+  using ProxyType = ComplexToComplexProxy<TPixel>;
+  using PixelType = typename ProxyType::PixelType;
+  using ComplexType = typename ProxyType::ComplexType;
+  using FFTWPlanType = typename ProxyType::PlanType;
+
+  /** Kind of transform performed by a plan. */
+  enum TransformKind
+  {
+    FORWARD = 0,
+    BACKWARD,
+    REAL_TO_COMPLEX,
+    COMPLEX_TO_REAL
+  };
+
+  /** Description of a plan. The lines are contiguous, InputDistance and
+   * OutputDistance are the number of elements between the start of two
+   * consecutive lines of a batch in the input and output arrays. The
+   * alignments are the values returned by ProxyType::AlignmentOf() for the
+   * arrays the plan will be executed on. */
+  struct Key
+  {
+    TransformKind Kind{ FORWARD };
+    int           LineSize{ 0 };
+    int           HowMany{ 1 };
+    int           InputDistance{ 0 };
+    int           OutputDistance{ 0 };
+    unsigned      Flags{ 0 };
+    int           Threads{ 1 };
+    int           InputAlignment{ 0 };
+    int           OutputAlignment{ 0 };
+
+    bool
+    operator<(const Key & other) const
+    {
+      return std::tie(Kind,
+                      LineSize,
+                      HowMany,
+                      InputDistance,
+                      OutputDistance,
+                      Flags,
+                      Threads,
+                      InputAlignment,
+                      OutputAlignment) < std::tie(other.Kind,
+                                                  other.LineSize,
+                                                  other.HowMany,
+                                                  other.InputDistance,
+                                                  other.OutputDistance,
+                                                  other.Flags,
+                                                  other.Threads,
+                                                  other.InputAlignment,
+                                                  other.OutputAlignment);
+    }
+  };
+
+  /** Owner of an FFTW plan, destroyed with the last reference to it. */
+  class Plan
+  {
+  public:
+    explicit Plan(FFTWPlanType plan)
+      : m_Plan(plan)
+    {}
+    ~Plan() { ProxyType::DestroyPlan(m_Plan); }
+    Plan(const Plan &) = delete;
+    Plan &
+    operator=(const Plan &) = delete;
+
+    FFTWPlanType
+    Get() const
+    {
+      return m_Plan;
+    }
+
+  private:
+    FFTWPlanType m_Plan;
+  };
+  using PlanPointer = std::shared_ptr<const Plan>;
+
+  /** Return the plan described by key, creating it on a cache miss. */
+  static PlanPointer
+  GetPlan(const Key & key)
+  {
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+
+    auto found = state.m_Plans.find(key);
+    if (found != state.m_Plans.end())
+    {
+      ++state.m_Hits;
+      // move the entry to the front of the LRU list
+      state.m_UsageList.splice(state.m_UsageList.begin(), state.m_UsageList, found->second.second);
+      return found->second.first;
+    }
+
+    ++state.m_Misses;
+    PlanPointer plan = std::make_shared<const Plan>(CreatePlan(key));
+    state.m_UsageList.push_front(key);
+    state.m_Plans.emplace(key, std::make_pair(plan, state.m_UsageList.begin()));
+    Trim(state);
+    return plan;
+  }
+
+  /** Convenience method to build a key from the arrays the plan will be
+   * executed on. */
+  template <typename TInput, typename TOutput>
+  static PlanPointer
+  GetPlan(TransformKind kind,
+          int           lineSize,
+          int           howMany,
+          TInput *      input,
+          int           inputDistance,
+          TOutput *     output,
+          int           outputDistance,
+          unsigned      flags,
+          int           threads = 1)
+  {
+    Key key;
+    key.Kind = kind;
+    key.LineSize = lineSize;
+    key.HowMany = howMany;
+    key.InputDistance = inputDistance;
+    key.OutputDistance = outputDistance;
+    key.Flags = flags;
+    key.Threads = threads;
+    key.InputAlignment = ProxyType::AlignmentOf(input);
+    key.OutputAlignment = ProxyType::AlignmentOf(output);
+    return GetPlan(key);
+  }
+
+  /** Set/Get the number of plans kept in the cache. Default is 64. */
+  static void
+  SetMaximumNumberOfPlans(SizeValueType maximum)
+  {
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    state.m_MaximumNumberOfPlans = maximum;
+    Trim(state);
+  }
+  static SizeValueType
+  GetMaximumNumberOfPlans()
+  {
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    return state.m_MaximumNumberOfPlans;
+  }
+
+  /** Number of plans currently held by the cache. */
+  static SizeValueType
+  GetNumberOfPlans()
+  {
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    return state.m_Plans.size();
+  }
+
+  /** Number of GetPlan() calls served from the cache, and number of calls
+   * that had to create a plan. */
+  static SizeValueType
+  GetHits()
+  {
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    return state.m_Hits;
+  }
+  static SizeValueType
+  GetMisses()
+  {
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    return state.m_Misses;
+  }
+
+  /** Drop all the plans from the cache and reset the hit and miss counters.
+   * Plans still used by filters are destroyed when they release them. */
+  static void
+  Clear()
+  {
+    State &                     state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_Mutex);
+    state.m_Plans.clear();
+    state.m_UsageList.clear();
+    state.m_Hits = 0;
+    state.m_Misses = 0;
+  }
+
+private:
+  using UsageListType = std::list<Key>;
+  using PlanMapType = std::map<Key, std::pair<PlanPointer, typename UsageListType::iterator>>;
+
+  struct State
+  {
+    std::mutex    m_Mutex;
+    PlanMapType   m_Plans;
+    UsageListType m_UsageList;
+    SizeValueType m_MaximumNumberOfPlans{ 64 };
+    SizeValueType m_Hits{ 0 };
+    SizeValueType m_Misses{ 0 };
+  };
+
+  static State &
+  GetState()
+  {
+    static State state;
+    return state;
+  }
+
+  /** Evict the least recently used plans. */
+  static void
+  Trim(State & state)
+  {
+    while (state.m_Plans.size() > state.m_MaximumNumberOfPlans)
+    {
+      state.m_Plans.erase(state.m_UsageList.back());
+      state.m_UsageList.pop_back();
+    }
+  }
+
+  /** Plan on scratch arrays with the alignments of the key: planning with a
+   * rigor above FFTW_ESTIMATE overwrites the arrays. */
+  static FFTWPlanType
+  CreatePlan(const Key & key)
+  {
+    // enough complex elements for any of the arrays of the batch
+    const SizeValueType arraySize =
+      std::max({ key.LineSize, key.InputDistance, key.OutputDistance }) * static_cast<SizeValueType>(key.HowMany);
+    // the alignment is an offset in bytes from FFTW's SIMD alignment
+    char * inputArray = static_cast<char *>(ProxyType::Malloc(arraySize * sizeof(ComplexType) + key.InputAlignment));
+    char * outputArray = static_cast<char *>(ProxyType::Malloc(arraySize * sizeof(ComplexType) + key.OutputAlignment));
+    if (inputArray == nullptr || outputArray == nullptr)
+    {
+      ProxyType::Free(inputArray);
+      ProxyType::Free(outputArray);
+      itkGenericExceptionMacro("Problem allocating memory for internal computations");
+    }
+    char * input = inputArray + key.InputAlignment;
+    char * output = outputArray + key.OutputAlignment;
+
+    FFTWPlanType plan;
+    switch (key.Kind)
+    {
+      case REAL_TO_COMPLEX:
+        plan = ProxyType::Plan_many_dft_r2c_1d(key.LineSize,
+                                               key.HowMany,
+                                               reinterpret_cast<PixelType *>(input),
+                                               1,
+                                               key.InputDistance,
+                                               reinterpret_cast<ComplexType *>(output),
+                                               1,
+                                               key.OutputDistance,
+                                               key.Flags,
+                                               key.Threads);
+        break;
+      case COMPLEX_TO_REAL:
+        plan = ProxyType::Plan_many_dft_c2r_1d(key.LineSize,
+                                               key.HowMany,
+                                               reinterpret_cast<ComplexType *>(input),
+                                               1,
+                                               key.InputDistance,
+                                               reinterpret_cast<PixelType *>(output),
+                                               1,
+                                               key.OutputDistance,
+                                               key.Flags,
+                                               key.Threads);
+        break;
+      default:
+        plan = ProxyType::Plan_many_dft_1d(key.LineSize,
+                                           key.HowMany,
+                                           reinterpret_cast<ComplexType *>(input),
+                                           1,
+                                           key.InputDistance,
+                                           reinterpret_cast<ComplexType *>(output),
+                                           1,
+                                           key.OutputDistance,
+                                           (key.Kind == FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD,
+                                           key.Flags,
+                                           key.Threads);
+        break;
+    }
+
+    ProxyType::Free(inputArray);
+    ProxyType::Free(outputArray);
+    if (plan == nullptr)
+    {
+      itkGenericExceptionMacro("Could not create FFTW plan for lines of size " << key.LineSize);
+    }
+    return plan;
+  }
+};
+
+} // end namespace fftw
+} // end namespace itk
+
+#endif // defined( ITK_USE_FFTWF ) || defined( ITK_USE_FFTWD )
+
+#endif // itkFFTW1DPlanCache_h
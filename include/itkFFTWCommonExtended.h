@@ -24,16 +24,139 @@
 #  else
 #    include "itkFFTWGlobalConfiguration.h"
 #    include "fftw3.h"
+#    if defined(ITKUltrasound_USE_FFTW_THREADS_CALLBACK)
+#      include "itkThreadPool.h"
+#    endif
 #  endif
 #endif
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <string>
 
 namespace itk
 {
 
 namespace fftw
 {
+#if defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD)
+/** Planning with any rigor above FFTW_ESTIMATE accumulates wisdom; let
+ * FFTWGlobalConfiguration know so that it is written to the wisdom cache when
+ * WriteWisdomCache is enabled. */
+inline void
+NotifyNewWisdom(unsigned flags)
+{
+#  ifndef ITK_USE_CUFFTW
+  if (!(flags & FFTW_ESTIMATE))
+  {
+    FFTWGlobalConfiguration::SetNewWisdomAvailable(true);
+  }
+#  else
+  (void)flags;
+#  endif
+}
+
+#  if defined(ITKUltrasound_USE_FFTW_THREADS_CALLBACK) && !defined(ITK_USE_CUFFTW)
+/** State of a parallel loop of FFTW dispatched onto the ITK thread pool. */
+struct ThreadPoolParallelLoopState
+{
+  void * (*m_Work)(char *);
+  char *                  m_JobData;
+  size_t                  m_ElementSize;
+  int                     m_NumberOfJobs;
+  std::atomic<int>        m_NextJob{ 0 };
+  std::atomic<int>        m_CompletedJobs{ 0 };
+  std::mutex              m_Mutex;
+  std::condition_variable m_Completed;
+};
+
+/** Run jobs of the loop until none is left to start. */
+inline void
+RunThreadPoolParallelLoopJobs(ThreadPoolParallelLoopState & state)
+{
+  for (int job = state.m_NextJob++; job < state.m_NumberOfJobs; job = state.m_NextJob++)
+  {
+    state.m_Work(state.m_JobData + job * state.m_ElementSize);
+    if (++state.m_CompletedJobs == state.m_NumberOfJobs)
+    {
+      std::lock_guard<std::mutex> lock(state.m_Mutex);
+      state.m_Completed.notify_all();
+    }
+  }
+}
+
+/** Parallel loop callback for fftw_threads_set_callback(): the jobs of FFTW
+ * are run by the ITK thread pool instead of threads spawned by FFTW. The
+ * calling thread takes part in the loop and only waits for the jobs that
+ * were started by other threads, so the loop completes even when it is
+ * called from a pool thread while all the others are busy, as happens when
+ * plans are executed inside the work units of a filter. */
+inline void
+ThreadPoolParallelLoop(void * (*work)(char *), char * jobData, size_t elementSize, int numberOfJobs, void *)
+{
+  auto state = std::make_shared<ThreadPoolParallelLoopState>();
+  state->m_Work = work;
+  state->m_JobData = jobData;
+  state->m_ElementSize = elementSize;
+  state->m_NumberOfJobs = numberOfJobs;
+
+  ThreadPool::Pointer threadPool = ThreadPool::GetInstance();
+  for (int helper = 1; helper < numberOfJobs; ++helper)
+  {
+    // helpers that start once all the jobs are taken return immediately
+    threadPool->AddWork([state]() { RunThreadPoolParallelLoopJobs(*state); });
+  }
+  RunThreadPoolParallelLoopJobs(*state);
+
+  std::unique_lock<std::mutex> lock(state->m_Mutex);
+  state->m_Completed.wait(lock, [&state]() { return state->m_CompletedJobs == state->m_NumberOfJobs; });
+}
+#  endif
+
+/** Whether the plans created with more than one thread run their parallel
+ * loops on the ITK thread pool. */
+inline std::atomic<bool> &
+UseITKThreadPoolFlag()
+{
+  static std::atomic<bool> useITKThreadPool{ false };
+  return useITKThreadPool;
+}
+
+/** Route the threads of the FFTW plans created with threads > 1 to the ITK
+ * thread pool, for both precisions, instead of letting FFTW spawn its own
+ * threads that compete with the ITK pool for the cores. This relies on
+ * fftw_threads_set_callback(), available from FFTW 3.3.9, and is only
+ * compiled in when ITKUltrasound_USE_FFTW_THREADS_CALLBACK is enabled.
+ * Returns false if the callback is not available. */
+inline bool
+SetUseITKThreadPool(bool use)
+{
+#  if defined(ITKUltrasound_USE_FFTW_THREADS_CALLBACK) && !defined(ITK_USE_CUFFTW)
+  std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+#    if defined(ITK_USE_FFTWF)
+  fftwf_threads_set_callback(use ? &ThreadPoolParallelLoop : nullptr, nullptr);
+#    endif
+#    if defined(ITK_USE_FFTWD)
+  fftw_threads_set_callback(use ? &ThreadPoolParallelLoop : nullptr, nullptr);
+#    endif
+  UseITKThreadPoolFlag() = use;
+  return true;
+#  else
+  (void)use;
+  return false;
+#  endif
+}
+
+inline bool
+GetUseITKThreadPool()
+{
+  return UseITKThreadPoolFlag();
+}
+#endif
+
 /**
  * \class Interface
  * \brief Wrapper for FFTW API
@@ -70,6 +193,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftwf_plan_dft_c2r_1d(n, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
   static PlanType
@@ -82,6 +206,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftwf_plan_dft_c2r_2d(nx, ny, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
   static PlanType
@@ -94,6 +219,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftwf_plan_dft_c2r_3d(nx, ny, nz, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
   static PlanType
@@ -106,6 +232,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftwf_plan_dft_c2r(rank, n, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
 
@@ -119,6 +246,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftwf_plan_dft_r2c_1d(n, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
   static PlanType
@@ -131,6 +259,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftwf_plan_dft_r2c_2d(nx, ny, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
   static PlanType
@@ -143,6 +272,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftwf_plan_dft_r2c_3d(nx, ny, nz, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
   static PlanType
@@ -155,6 +285,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftwf_plan_dft_r2c(rank, n, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
   static PlanType
@@ -167,6 +298,77 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftwf_plan_dft_1d(n, in, out, sign, flags);
+    NotifyNewWisdom(flags);
+    return plan;
+  }
+  static PlanType
+  Plan_many_dft_1d(const int     n,
+                   const int     howmany,
+                   ComplexType * in,
+                   const int     istride,
+                   const int     idist,
+                   ComplexType * out,
+                   const int     ostride,
+                   const int     odist,
+                   int           sign,
+                   unsigned      flags,
+                   int           threads = 1)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    fftwf_plan_with_nthreads(threads);
+#  else
+    (void)threads;
+#  endif
+    PlanType plan =
+      fftwf_plan_many_dft(1, &n, howmany, in, nullptr, istride, idist, out, nullptr, ostride, odist, sign, flags);
+    NotifyNewWisdom(flags);
+    return plan;
+  }
+  static PlanType
+  Plan_many_dft_r2c_1d(const int     n,
+                       const int     howmany,
+                       PixelType *   in,
+                       const int     istride,
+                       const int     idist,
+                       ComplexType * out,
+                       const int     ostride,
+                       const int     odist,
+                       unsigned      flags,
+                       int           threads = 1)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    fftwf_plan_with_nthreads(threads);
+#  else
+    (void)threads;
+#  endif
+    PlanType plan =
+      fftwf_plan_many_dft_r2c(1, &n, howmany, in, nullptr, istride, idist, out, nullptr, ostride, odist, flags);
+    NotifyNewWisdom(flags);
+    return plan;
+  }
+  static PlanType
+  Plan_many_dft_c2r_1d(const int     n,
+                       const int     howmany,
+                       ComplexType * in,
+                       const int     istride,
+                       const int     idist,
+                       PixelType *   out,
+                       const int     ostride,
+                       const int     odist,
+                       unsigned      flags,
+                       int           threads = 1)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    fftwf_plan_with_nthreads(threads);
+#  else
+    (void)threads;
+#  endif
+    PlanType plan =
+      fftwf_plan_many_dft_c2r(1, &n, howmany, in, nullptr, istride, idist, out, nullptr, ostride, odist, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
 
@@ -176,11 +378,85 @@ public:
   {
     fftwf_execute(p);
   }
+  /** Execute a plan on arrays other than the ones it was created with. The
+   * arrays must have the same layout and AlignmentOf() as the original ones. */
+  static void
+  Execute_dft(PlanType p, ComplexType * in, ComplexType * out)
+  {
+    fftwf_execute_dft(p, in, out);
+  }
+  static void
+  Execute_dft_r2c(PlanType p, PixelType * in, ComplexType * out)
+  {
+    fftwf_execute_dft_r2c(p, in, out);
+  }
+  /** c2r plans overwrite their input. */
+  static void
+  Execute_dft_c2r(PlanType p, ComplexType * in, PixelType * out)
+  {
+    fftwf_execute_dft_c2r(p, in, out);
+  }
+  static int
+  AlignmentOf(PixelType * p)
+  {
+#  ifndef ITK_USE_CUFFTW
+    return fftwf_alignment_of(p);
+#  else
+    return static_cast<int>(reinterpret_cast<std::uintptr_t>(p) % 16);
+#  endif
+  }
+  static int
+  AlignmentOf(ComplexType * p)
+  {
+    return AlignmentOf(reinterpret_cast<PixelType *>(p));
+  }
   static void
   DestroyPlan(PlanType p)
   {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+#  endif
     fftwf_destroy_plan(p);
   }
+  /** Allocate memory with the SIMD alignment preferred by FFTW. */
+  static void *
+  Malloc(size_t n)
+  {
+    return fftwf_malloc(n);
+  }
+  static void
+  Free(void * p)
+  {
+    fftwf_free(p);
+  }
+
+  /** Import FFTW wisdom for this precision from a file, as written by
+   * ExportWisdomFile(). Returns true on success. */
+  static bool
+  ImportWisdomFile(const std::string & filename)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    return fftwf_import_wisdom_from_filename(filename.c_str()) != 0;
+#  else
+    (void)filename;
+    return false;
+#  endif
+  }
+
+  /** Export the FFTW wisdom accumulated for this precision to a file. Returns
+   * true on success. */
+  static bool
+  ExportWisdomFile(const std::string & filename)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    return fftwf_export_wisdom_to_filename(filename.c_str()) != 0;
+#  else
+    (void)filename;
+    return false;
+#  endif
+  }
 };
 
 #endif // USE_FFTWF
@@ -206,6 +482,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftw_plan_dft_c2r_1d(n, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
   static PlanType
@@ -218,6 +495,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftw_plan_dft_c2r_2d(nx, ny, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
   static PlanType
@@ -230,6 +508,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftw_plan_dft_c2r_3d(nx, ny, nz, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
   static PlanType
@@ -242,6 +521,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftw_plan_dft_c2r(rank, n, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
 
@@ -255,6 +535,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftw_plan_dft_r2c_1d(n, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
 
@@ -268,6 +549,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftw_plan_dft_r2c_2d(nx, ny, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
 
@@ -281,6 +563,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftw_plan_dft_r2c_3d(nx, ny, nz, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
 
@@ -294,6 +577,7 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftw_plan_dft_r2c(rank, n, in, out, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
   static PlanType
@@ -306,6 +590,77 @@ public:
     (void)threads;
 #  endif
     PlanType plan = fftw_plan_dft_1d(n, in, out, sign, flags);
+    NotifyNewWisdom(flags);
+    return plan;
+  }
+  static PlanType
+  Plan_many_dft_1d(const int     n,
+                   const int     howmany,
+                   ComplexType * in,
+                   const int     istride,
+                   const int     idist,
+                   ComplexType * out,
+                   const int     ostride,
+                   const int     odist,
+                   int           sign,
+                   unsigned      flags,
+                   int           threads = 1)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    fftw_plan_with_nthreads(threads);
+#  else
+    (void)threads;
+#  endif
+    PlanType plan =
+      fftw_plan_many_dft(1, &n, howmany, in, nullptr, istride, idist, out, nullptr, ostride, odist, sign, flags);
+    NotifyNewWisdom(flags);
+    return plan;
+  }
+  static PlanType
+  Plan_many_dft_r2c_1d(const int     n,
+                       const int     howmany,
+                       PixelType *   in,
+                       const int     istride,
+                       const int     idist,
+                       ComplexType * out,
+                       const int     ostride,
+                       const int     odist,
+                       unsigned      flags,
+                       int           threads = 1)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    fftw_plan_with_nthreads(threads);
+#  else
+    (void)threads;
+#  endif
+    PlanType plan =
+      fftw_plan_many_dft_r2c(1, &n, howmany, in, nullptr, istride, idist, out, nullptr, ostride, odist, flags);
+    NotifyNewWisdom(flags);
+    return plan;
+  }
+  static PlanType
+  Plan_many_dft_c2r_1d(const int     n,
+                       const int     howmany,
+                       ComplexType * in,
+                       const int     istride,
+                       const int     idist,
+                       PixelType *   out,
+                       const int     ostride,
+                       const int     odist,
+                       unsigned      flags,
+                       int           threads = 1)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    fftw_plan_with_nthreads(threads);
+#  else
+    (void)threads;
+#  endif
+    PlanType plan =
+      fftw_plan_many_dft_c2r(1, &n, howmany, in, nullptr, istride, idist, out, nullptr, ostride, odist, flags);
+    NotifyNewWisdom(flags);
     return plan;
   }
 
@@ -314,11 +669,85 @@ public:
   {
     fftw_execute(p);
   }
+  /** Execute a plan on arrays other than the ones it was created with. The
+   * arrays must have the same layout and AlignmentOf() as the original ones. */
+  static void
+  Execute_dft(PlanType p, ComplexType * in, ComplexType * out)
+  {
+    fftw_execute_dft(p, in, out);
+  }
+  static void
+  Execute_dft_r2c(PlanType p, PixelType * in, ComplexType * out)
+  {
+    fftw_execute_dft_r2c(p, in, out);
+  }
+  /** c2r plans overwrite their input. */
+  static void
+  Execute_dft_c2r(PlanType p, ComplexType * in, PixelType * out)
+  {
+    fftw_execute_dft_c2r(p, in, out);
+  }
+  static int
+  AlignmentOf(PixelType * p)
+  {
+#  ifndef ITK_USE_CUFFTW
+    return fftw_alignment_of(p);
+#  else
+    return static_cast<int>(reinterpret_cast<std::uintptr_t>(p) % 16);
+#  endif
+  }
+  static int
+  AlignmentOf(ComplexType * p)
+  {
+    return AlignmentOf(reinterpret_cast<PixelType *>(p));
+  }
   static void
   DestroyPlan(PlanType p)
   {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+#  endif
     fftw_destroy_plan(p);
   }
+  /** Allocate memory with the SIMD alignment preferred by FFTW. */
+  static void *
+  Malloc(size_t n)
+  {
+    return fftw_malloc(n);
+  }
+  static void
+  Free(void * p)
+  {
+    fftw_free(p);
+  }
+
+  /** Import FFTW wisdom for this precision from a file, as written by
+   * ExportWisdomFile(). Returns true on success. */
+  static bool
+  ImportWisdomFile(const std::string & filename)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    return fftw_import_wisdom_from_filename(filename.c_str()) != 0;
+#  else
+    (void)filename;
+    return false;
+#  endif
+  }
+
+  /** Export the FFTW wisdom accumulated for this precision to a file. Returns
+   * true on success. */
+  static bool
+  ExportWisdomFile(const std::string & filename)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    return fftw_export_wisdom_to_filename(filename.c_str()) != 0;
+#  else
+    (void)filename;
+    return false;
+#  endif
+  }
 };
 
 #endif
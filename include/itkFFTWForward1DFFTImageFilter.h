@@ -19,9 +19,13 @@
 #define itkFFTWForward1DFFTImageFilter_h
 
 #include "itkForward1DFFTImageFilter.h"
+#include "itkFFT1DScratchArena.h"
+#include "itkFFT1DWorkBufferPool.h"
+#include "itkFFTW1DPlanCache.h"
 #include "itkFFTWCommonExtended.h"
-#include "itkImageRegionSplitterDirection.h"
 
+#include <memory>
+#include <string>
 #include <vector>
 
 
@@ -31,10 +35,21 @@ namespace itk
 /** \class FFTWForward1DFFTImageFilter
  * \brief only do FFT along one dimension using FFTW as a backend.
  *
+ * The real input lines are transformed with real-to-complex plans, which
+ * compute only the non-negative frequency half of the spectrum; unless
+ * HalfSpectrum is on, the negative frequencies of the output are filled in
+ * from the Hermitian symmetry.
+ *
+ * The filter runs with dynamic multithreading: the work units never split the
+ * lines and check their line buffers out of a pool, so any number of work
+ * units can be used.
+ *
  * \ingroup Ultrasound
  */
 template <typename TInputImage,
-          typename TOutputImage = Image<std::complex<typename TInputImage::PixelType>, TInputImage::ImageDimension>>
+          typename TOutputImage =
+            Image<std::complex<typename fft1d::RealFFTPrecision<typename TInputImage::PixelType>::Type>,
+                  TInputImage::ImageDimension>>
 class ITK_TEMPLATE_EXPORT FFTWForward1DFFTImageFilter : public Forward1DFFTImageFilter<TInputImage, TOutputImage>
 {
 public:
@@ -57,9 +72,10 @@ public:
    * is trying to use double if only the float FFTW1D version is
    * configured in, or float if only double is configured.
    */
-  using FFTW1DProxyType = typename fftw::ComplexToComplexProxy<typename TInputImage::PixelType>;
-  using PlanArrayType = typename std::vector<typename FFTW1DProxyType::PlanType>;
-  using PlanBufferPointerType = typename std::vector<typename FFTW1DProxyType::ComplexType *>;
+  using FFTW1DProxyType =
+    typename fftw::ComplexToComplexProxy<typename NumericTraits<typename TOutputImage::PixelType>::ValueType>;
+  using PlanCacheType =
+    typename fftw::FFTW1DPlanCache<typename NumericTraits<typename TOutputImage::PixelType>::ValueType>;
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
@@ -67,34 +83,101 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(FFTWForward1DFFTImageFilter, Forward1DFFTImageFilter);
 
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const override
+  {
+    return 13; // FFTW has codelets for the prime factors up to 13
+  }
+
+  /**
+   * Set/Get the behavior of wisdom plan creation. The default is
+   * provided by FFTWGlobalConfiguration::GetPlanRigor().
+   *
+   * The parameter is one of the FFTW planner rigor flags FFTW_ESTIMATE, FFTW_MEASURE,
+   * FFTW_PATIENT, FFTW_EXHAUSTIVE provided by FFTWGlobalConfiguration.
+   * Plans more rigorous than FFTW_ESTIMATE are expensive to compute, but the
+   * resulting wisdom can be saved with FFTW1DProxyType::ExportWisdomFile() or
+   * the FFTWGlobalConfiguration wisdom cache and reused by later processes.
+   *
+   * \sa FFTWGlobalConfiguration
+   */
+  virtual void
+  SetPlanRigor(const int & value);
+  itkGetConstReferenceMacro(PlanRigor, int);
+  void
+  SetPlanRigor(const std::string & name);
+
+  /**
+   * Set/Get the number of lines transformed by a single FFTW execution. With
+   * a value greater than one, the lines of each work unit are transformed in
+   * batches with a plan created by fftw_plan_many_dft, and batches that are
+   * stored back to back in the image buffer (Direction 0) are read or written
+   * directly in the buffer instead of being copied through the internal line
+   * buffers. Remaining lines are transformed one at a time. Lines along
+   * other directions are strided in memory: they are copied in tiles of
+   * adjacent lines, a row of the tile at a time, and transformed in batches of
+   * at least fft1d::MaximumLineTileSize lines. Default is 1.
+   */
+  itkSetClampMacro(BatchSize, SizeValueType, 1, NumericTraits<SizeValueType>::max());
+  itkGetConstMacro(BatchSize, SizeValueType);
+
+  /**
+   * Set/Get the number of threads FFTW uses within a single execution of a
+   * plan. Values greater than one help with long lines when there are fewer
+   * lines than threads. See fftw::SetUseITKThreadPool() to run these threads
+   * on the ITK thread pool instead of threads spawned by FFTW. Default is 1.
+   */
+  itkSetClampMacro(NumberOfPlanThreads, int, 1, NumericTraits<int>::max());
+  itkGetConstMacro(NumberOfPlanThreads, int);
+
 
 protected:
   FFTWForward1DFFTImageFilter();
   virtual ~FFTWForward1DFFTImageFilter();
 
   void
-  BeforeThreadedGenerateData() override;
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Transform the lines in work units that do not split them along the
+   * direction we are performing the transform. */
   void
-  ThreadedGenerateData(const OutputImageRegionType &, ThreadIdType threadID) override;
+  GenerateData() override;
 
-  /** Override to return a splitter that does not split along the direction we
-   *  are performing the transform. */
-  const ImageRegionSplitterBase *
-  GetImageRegionSplitter() const override;
+  void
+  BeforeThreadedGenerateData() override;
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegion) override;
 
 
 private:
-  ImageRegionSplitterDirection::Pointer m_ImageRegionSplitter;
-
-  /** Destroy FFTW Plans and associated buffers. */
+  /** Line buffers of a work unit and the plans matching their alignment. */
+  struct WorkBuffers
+  {
+    fft1d::ScratchBuffer<typename FFTW1DProxyType::PixelType>   InputBuffer;
+    fft1d::ScratchBuffer<typename FFTW1DProxyType::ComplexType> OutputBuffer;
+    typename PlanCacheType::PlanPointer                         Plan;
+    typename PlanCacheType::PlanPointer                         BatchPlan;
+  };
+  using WorkBufferPoolType = fft1d::WorkBufferPool<WorkBuffers>;
+
+  /** Allocate the line buffers of a work unit and get their plans. */
+  std::unique_ptr<WorkBuffers>
+  CreateWorkBuffers() const;
+
+  /** Release the FFTW plans and free the associated buffers. */
   void
   DestroyPlans();
 
-  bool                  m_PlanComputed;
-  PlanArrayType         m_PlanArray;
-  unsigned int          m_LastImageSize;
-  PlanBufferPointerType m_InputBufferArray;
-  PlanBufferPointerType m_OutputBufferArray;
+  bool               m_PlanComputed;
+  unsigned int       m_LastImageSize;
+  int                m_PlanRigor;
+  int                m_LastPlanRigor;
+  SizeValueType      m_BatchSize;
+  SizeValueType      m_LastBatchSize;
+  int                m_NumberOfPlanThreads;
+  int                m_LastNumberOfPlanThreads;
+  bool               m_LastHalfSpectrum;
+  WorkBufferPoolType m_WorkBufferPool;
 };
 
 } // namespace itk
@@ -21,12 +21,14 @@
 #include "itkForward1DFFTImageFilter.hxx"
 #include "itkFFTWForward1DFFTImageFilter.h"
 
+#include "itkFFT1DLineBatch.h"
 #include "itkFFTWCommonExtended.h"
 #include "itkIndent.h"
-#include "itkImageLinearConstIteratorWithIndex.h"
-#include "itkImageLinearIteratorWithIndex.h"
 #include "itkMetaDataObject.h"
 
+#include <algorithm>
+#include <type_traits>
+
 #if defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD)
 
 namespace itk
@@ -36,10 +38,18 @@ template <typename TInputImage, typename TOutputImage>
 FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::FFTWForward1DFFTImageFilter()
   : m_PlanComputed(false)
   , m_LastImageSize(0)
+  , m_LastPlanRigor(0)
+  , m_BatchSize(1)
+  , m_LastBatchSize(0)
+  , m_NumberOfPlanThreads(1)
+  , m_LastNumberOfPlanThreads(0)
+  , m_LastHalfSpectrum(false)
 {
-  // We cannot split over the FFT direction
-  this->m_ImageRegionSplitter = ImageRegionSplitterDirection::New();
-  this->DynamicMultiThreadingOff();
+#  ifndef ITK_USE_CUFFTW
+  m_PlanRigor = FFTWGlobalConfiguration::GetPlanRigor();
+#  else
+  m_PlanRigor = FFTW_ESTIMATE;
+#  endif
 }
 
 
@@ -57,119 +67,306 @@ template <typename TInputImage, typename TOutputImage>
 void
 FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::DestroyPlans()
 {
-  for (unsigned int i = 0; i < m_PlanArray.size(); i++)
+  // the plans are destroyed by the plan cache once nobody uses them
+  m_WorkBufferPool.Clear();
+  this->m_PlanComputed = false;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::SetPlanRigor(const int & value)
+{
+#  ifndef ITK_USE_CUFFTW
+  // Use that method to check the value
+  FFTWGlobalConfiguration::GetPlanRigorName(value);
+#  endif
+  if (this->m_PlanRigor != value)
   {
-    FFTW1DProxyType::DestroyPlan(m_PlanArray[i]);
-    delete[] m_InputBufferArray[i];
-    delete[] m_OutputBufferArray[i];
-    this->m_PlanComputed = false;
+    this->m_PlanRigor = value;
+    this->Modified();
   }
 }
 
 
 template <typename TInputImage, typename TOutputImage>
-const ImageRegionSplitterBase *
-FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::GetImageRegionSplitter() const
+void
+FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::SetPlanRigor(const std::string & name)
 {
-  return this->m_ImageRegionSplitter.GetPointer();
+#  ifndef ITK_USE_CUFFTW
+  this->SetPlanRigor(FFTWGlobalConfiguration::GetPlanRigorValue(name));
+#  else
+  (void)name;
+#  endif
 }
 
 
 template <typename TInputImage, typename TOutputImage>
 void
-FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateData()
+FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
 {
-  Superclass::BeforeThreadedGenerateData();
+  Superclass::PrintSelf(os, indent);
+
+#  ifndef ITK_USE_CUFFTW
+  os << indent << "PlanRigor: " << FFTWGlobalConfiguration::GetPlanRigorName(m_PlanRigor) << " (" << m_PlanRigor
+     << ")" << std::endl;
+#  else
+  os << indent << "PlanRigor: " << m_PlanRigor << std::endl;
+#  endif
+  os << indent << "BatchSize: " << m_BatchSize << std::endl;
+  os << indent << "NumberOfPlanThreads: " << m_NumberOfPlanThreads << std::endl;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+  this->BeforeThreadedGenerateData();
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegionRestrictDirection<OutputImageType::ImageDimension>(
+    this->GetDirection(),
+    this->GetOutput()->GetRequestedRegion(),
+    [this](const OutputImageRegionType & outputRegion) { this->DynamicThreadedGenerateData(outputRegion); },
+    this);
 
-  this->m_ImageRegionSplitter->SetDirection(this->GetDirection());
+  this->AfterThreadedGenerateData();
+}
 
-  OutputImageType * outputPtr = this->GetOutput();
 
-  const typename OutputImageType::SizeType & outputSize = outputPtr->GetRequestedRegion().GetSize();
-  const unsigned int                         lineSize = outputSize[this->GetDirection()];
+template <typename TInputImage, typename TOutputImage>
+void
+FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  // the plans transform the lines zero padded to the transform size
+  const unsigned int lineSize = this->GetTransformLineSize();
+  // strided lines are batched a tile at a time, see fft1d::ForEachLineTile
+  const SizeValueType batchSize =
+    (this->GetDirection() == 0) ? this->m_BatchSize : std::max(this->m_BatchSize, fft1d::MaximumLineTileSize);
+  // the plans only compute the non-negative frequencies when the output bins
+  // are all among them
+  const bool halfSpectrum = this->GetComputedSpectrumSize() < lineSize;
 
   if (this->m_PlanComputed)
   {
-    // if the image sizes aren't the same,
-    // we have to compute the plan again
-    if (this->m_LastImageSize != lineSize)
+    // if the image sizes, the plan rigor, the batch size, the number of plan
+    // threads or the output spectrum layout aren't the same, we have to
+    // compute the plan again
+    if (this->m_LastImageSize != lineSize || this->m_LastPlanRigor != this->m_PlanRigor ||
+        this->m_LastBatchSize != batchSize || this->m_LastNumberOfPlanThreads != this->m_NumberOfPlanThreads ||
+        this->m_LastHalfSpectrum != halfSpectrum)
     {
       this->DestroyPlans();
     }
   }
   if (!this->m_PlanComputed)
   {
-    const int threads = this->GetNumberOfWorkUnits();
-    m_PlanArray.resize(threads);
-    m_InputBufferArray.resize(threads);
-    m_OutputBufferArray.resize(threads);
-    for (int i = 0; i < threads; i++)
-    {
-      try
-      {
-        m_InputBufferArray[i] = new typename FFTW1DProxyType::ComplexType[lineSize];
-        m_OutputBufferArray[i] = new typename FFTW1DProxyType::ComplexType[lineSize];
-      }
-      catch (std::bad_alloc &)
-      {
-        itkExceptionMacro("Problem allocating memory for internal computations");
-      }
-      m_PlanArray[i] = FFTW1DProxyType::Plan_dft_1d(
-        lineSize, m_InputBufferArray[i], m_OutputBufferArray[i], FFTW_FORWARD, FFTW_ESTIMATE, 1);
-    }
+    // the buffers and plans of the work units are created on demand
     this->m_LastImageSize = lineSize;
+    this->m_LastPlanRigor = this->m_PlanRigor;
+    this->m_LastBatchSize = batchSize;
+    this->m_LastNumberOfPlanThreads = this->m_NumberOfPlanThreads;
+    this->m_LastHalfSpectrum = halfSpectrum;
     this->m_PlanComputed = true;
   }
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+auto
+FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::CreateWorkBuffers() const -> std::unique_ptr<WorkBuffers>
+{
+  const unsigned int lineSize = this->m_LastImageSize;
+  // only the non-negative frequencies are computed when the output bins are
+  // all among them
+  const unsigned int outputLineSize = this->m_LastHalfSpectrum ? lineSize / 2 + 1 : lineSize;
+
+  // the line buffers come from the scratch arena, aligned for the SIMD codelets
+  std::unique_ptr<WorkBuffers> buffers(new WorkBuffers);
+  try
+  {
+    buffers->InputBuffer.Allocate(lineSize * this->m_LastBatchSize);
+    buffers->OutputBuffer.Allocate(outputLineSize * this->m_LastBatchSize);
+  }
+  catch (std::bad_alloc &)
+  {
+    itkExceptionMacro("Problem allocating memory for internal computations");
+  }
+  // the r2c plans only write the first lineSize / 2 + 1 bins of each output
+  // line; the plans are shared with the other filters through the plan cache
+  buffers->Plan = PlanCacheType::GetPlan(PlanCacheType::REAL_TO_COMPLEX,
+                                         lineSize,
+                                         1,
+                                         buffers->InputBuffer.data(),
+                                         lineSize,
+                                         buffers->OutputBuffer.data(),
+                                         outputLineSize,
+                                         this->m_LastPlanRigor,
+                                         this->m_LastNumberOfPlanThreads);
+  if (this->m_LastBatchSize > 1)
+  {
+    buffers->BatchPlan = PlanCacheType::GetPlan(PlanCacheType::REAL_TO_COMPLEX,
+                                                lineSize,
+                                                static_cast<int>(this->m_LastBatchSize),
+                                                buffers->InputBuffer.data(),
+                                                lineSize,
+                                                buffers->OutputBuffer.data(),
+                                                outputLineSize,
+                                                this->m_LastPlanRigor,
+                                                this->m_LastNumberOfPlanThreads);
+  }
+  return buffers;
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 void
-FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const OutputImageRegionType & outputRegion,
-                                                                             ThreadIdType                  threadID)
+FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegion)
 {
   // get pointers to the input and output
   const InputImageType * inputPtr = this->GetInput();
   OutputImageType *      outputPtr = this->GetOutput();
 
-  using InputIteratorType = itk::ImageLinearConstIteratorWithIndex<InputImageType>;
-  using OutputIteratorType = itk::ImageLinearIteratorWithIndex<OutputImageType>;
-  InputIteratorType  inputIt(inputPtr, outputRegion);
-  OutputIteratorType outputIt(outputPtr, outputRegion);
+  const unsigned int  direction = this->GetDirection();
+  const unsigned int  tileDimension = fft1d::GetLineTileDimension(direction);
+  const SizeValueType inputLineSize = inputPtr->GetRequestedRegion().GetSize(direction);
+  const SizeValueType lineSize = this->m_LastImageSize;
+  const SizeValueType outputLineSize = outputRegion.GetSize(direction);
+  const SizeValueType batchSize = this->m_LastBatchSize;
+  // the output lines hold outputLineSize bins of the computed spectrum, from
+  // firstBin on
+  const SizeValueType spectrumLineSize = this->m_LastHalfSpectrum ? lineSize / 2 + 1 : lineSize;
+  const SizeValueType firstBin = this->GetFirstOutputBin();
 
-  inputIt.SetDirection(this->GetDirection());
-  outputIt.SetDirection(this->GetDirection());
+  using InputPixelType = typename InputImageType::PixelType;
+  using RealType = typename FFTW1DProxyType::PixelType;
+  using ComplexType = typename FFTW1DProxyType::ComplexType;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using IndexType = typename OutputImageType::IndexType;
 
-  typename FFTW1DProxyType::ComplexType * inputBufferIt;
-  typename FFTW1DProxyType::ComplexType * outputBufferIt;
+  std::vector<IndexType> lineStarts;
+  lineStarts.reserve(batchSize);
 
-  // for every fft line
-  for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); outputIt.NextLine(), inputIt.NextLine())
-  {
-    // copy the input line into our buffer
-    inputIt.GoToBeginOfLine();
-    inputBufferIt = m_InputBufferArray[threadID];
-    while (!inputIt.IsAtEndOfLine())
+  // use a set of line buffers of the pool for this work unit
+  typename WorkBufferPoolType::BuffersPointer buffers =
+    m_WorkBufferPool.CheckOut([this]() { return this->CreateWorkBuffers(); });
+
+  // transform lines adjacent along the tile dimension with a single plan
+  // execution; the output lines are shorter than the input ones in
+  // HalfSpectrum mode, both start at the same index along the direction
+  const auto transformLines = [&](const IndexType & firstLineStart, const SizeValueType lines) {
+    lineStarts.clear();
+    if (direction == 0)
+    {
+      for (SizeValueType line = 0; line < lines; ++line)
+      {
+        IndexType lineStart = firstLineStart;
+        if (line > 0)
+        {
+          lineStart[tileDimension] += static_cast<IndexValueType>(line);
+        }
+        lineStarts.push_back(lineStart);
+      }
+    }
+
+    // read and write the lines in place in the image buffers when they are
+    // stored back to back and the alignment is the one the plan was created
+    // with; the out-of-place r2c plans preserve their input. Integer input
+    // pixels are converted to the plan precision while they are gathered, and
+    // zero padded lines are always gathered
+    RealType * inputBuffer = buffers->InputBuffer.data();
+    RealType * inputLines = nullptr;
+    if (std::is_same<InputPixelType, RealType>::value && inputLineSize == lineSize)
+    {
+      inputLines = const_cast<RealType *>(
+        reinterpret_cast<const RealType *>(fft1d::ContiguousLines(inputPtr, lineStarts, lineSize, direction)));
+    }
+    if (inputLines != nullptr && FFTW1DProxyType::AlignmentOf(inputLines) == FFTW1DProxyType::AlignmentOf(inputBuffer))
+    {
+      inputBuffer = inputLines;
+    }
+    else
     {
-      (*inputBufferIt)[0] = inputIt.Get();
-      (*inputBufferIt)[1] = 0.;
-      ++inputIt;
-      ++inputBufferIt;
+      // copy the input lines into our buffer; FFTW has no input pruning, so
+      // the padding of each line is read as zeros
+      fft1d::GatherLineTile(inputPtr, firstLineStart, direction, inputLineSize, lines, inputBuffer, lineSize);
+      for (SizeValueType line = 0; inputLineSize < lineSize && line < lines; ++line)
+      {
+        std::fill(inputBuffer + line * lineSize + inputLineSize, inputBuffer + (line + 1) * lineSize, RealType(0));
+      }
+    }
+    ComplexType * outputBuffer = buffers->OutputBuffer.data();
+    ComplexType * outputLines = nullptr;
+    if (firstBin == 0 && outputLineSize == spectrumLineSize)
+    {
+      outputLines =
+        reinterpret_cast<ComplexType *>(fft1d::ContiguousLines(outputPtr, lineStarts, outputLineSize, direction));
+    }
+    if (outputLines != nullptr &&
+        FFTW1DProxyType::AlignmentOf(outputLines) == FFTW1DProxyType::AlignmentOf(outputBuffer))
+    {
+      outputBuffer = outputLines;
     }
 
     // do the transform
-    FFTW1DProxyType::Execute(m_PlanArray[threadID]);
+    FFTW1DProxyType::Execute_dft_r2c(
+      (lines > 1) ? buffers->BatchPlan->Get() : buffers->Plan->Get(), inputBuffer, outputBuffer);
 
-    // copy the output from the buffer into our line
-    outputBufferIt = m_OutputBufferArray[threadID];
-    outputIt.GoToBeginOfLine();
-    while (!outputIt.IsAtEndOfLine())
+    if (!this->m_LastHalfSpectrum)
     {
-      outputIt.Set(*(reinterpret_cast<typename OutputIteratorType::PixelType *>(outputBufferIt)));
-      ++outputIt;
-      ++outputBufferIt;
+      // fill in the negative frequencies from the Hermitian symmetry of the
+      // spectrum of a real signal
+      for (SizeValueType line = 0; line < lines; ++line)
+      {
+        ComplexType * spectrum = outputBuffer + line * lineSize;
+        for (SizeValueType k = lineSize / 2 + 1; k < lineSize; ++k)
+        {
+          spectrum[k][0] = spectrum[lineSize - k][0];
+          spectrum[k][1] = -spectrum[lineSize - k][1];
+        }
+      }
     }
-  }
+
+    if (outputBuffer != outputLines)
+    {
+      // copy the output from the buffer into our lines
+      fft1d::ScatterLineTile(outputPtr,
+                             firstLineStart,
+                             direction,
+                             outputLineSize,
+                             lines,
+                             reinterpret_cast<const OutputPixelType *>(outputBuffer + firstBin),
+                             spectrumLineSize);
+    }
+  };
+
+  // for every tile of fft lines
+  fft1d::ForEachLineTile(
+    outputRegion, direction, batchSize, [&](const IndexType & tileStart, const SizeValueType numberOfLines) {
+      if (numberOfLines == batchSize)
+      {
+        transformLines(tileStart, batchSize);
+        return;
+      }
+      // remaining lines are transformed one at a time
+      IndexType lineStart = tileStart;
+      for (SizeValueType line = 0; line < numberOfLines; ++line)
+      {
+        if (line > 0)
+        {
+          ++lineStart[tileDimension];
+        }
+        transformLines(lineStart, 1);
+      }
+    });
+
+  m_WorkBufferPool.CheckIn(std::move(buffers));
 }
 
 } // namespace itk
@@ -21,13 +21,14 @@
 #include "itkInverse1DFFTImageFilter.hxx"
 #include "itkFFTWInverse1DFFTImageFilter.h"
 
+#include "itkFFT1DLineBatch.h"
 #include "itkFFTWCommonExtended.h"
 #include "itkIndent.h"
-#include "itkImageLinearConstIteratorWithIndex.h"
-#include "itkImageLinearIteratorWithIndex.h"
 #include "itkMetaDataObject.h"
 #include "itkMultiThreaderBase.h"
 
+#include <algorithm>
+
 #if defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD)
 
 namespace itk
@@ -37,10 +38,18 @@ template <typename TInputImage, typename TOutputImage>
 FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::FFTWInverse1DFFTImageFilter()
   : m_PlanComputed(false)
   , m_LastImageSize(0)
+  , m_LastPlanRigor(0)
+  , m_BatchSize(1)
+  , m_LastBatchSize(0)
+  , m_NumberOfPlanThreads(1)
+  , m_LastNumberOfPlanThreads(0)
+  , m_LastComplexToReal(false)
 {
-  // We cannot split over the FFT direction
-  this->m_ImageRegionSplitter = ImageRegionSplitterDirection::New();
-  this->DynamicMultiThreadingOff();
+#  ifndef ITK_USE_CUFFTW
+  m_PlanRigor = FFTWGlobalConfiguration::GetPlanRigor();
+#  else
+  m_PlanRigor = FFTW_ESTIMATE;
+#  endif
 }
 
 
@@ -58,21 +67,73 @@ template <typename TInputImage, typename TOutputImage>
 void
 FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::DestroyPlans()
 {
-  for (unsigned int i = 0; i < m_PlanArray.size(); i++)
+  // the plans are destroyed by the plan cache once nobody uses them
+  m_WorkBufferPool.Clear();
+  this->m_PlanComputed = false;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::SetPlanRigor(const int & value)
+{
+#  ifndef ITK_USE_CUFFTW
+  // Use that method to check the value
+  FFTWGlobalConfiguration::GetPlanRigorName(value);
+#  endif
+  if (this->m_PlanRigor != value)
   {
-    FFTW1DProxyType::DestroyPlan(m_PlanArray[i]);
-    delete[] m_InputBufferArray[i];
-    delete[] m_OutputBufferArray[i];
-    this->m_PlanComputed = false;
+    this->m_PlanRigor = value;
+    this->Modified();
   }
 }
 
 
 template <typename TInputImage, typename TOutputImage>
-const ImageRegionSplitterBase *
-FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::GetImageRegionSplitter() const
+void
+FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::SetPlanRigor(const std::string & name)
 {
-  return this->m_ImageRegionSplitter.GetPointer();
+#  ifndef ITK_USE_CUFFTW
+  this->SetPlanRigor(FFTWGlobalConfiguration::GetPlanRigorValue(name));
+#  else
+  (void)name;
+#  endif
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+#  ifndef ITK_USE_CUFFTW
+  os << indent << "PlanRigor: " << FFTWGlobalConfiguration::GetPlanRigorName(m_PlanRigor) << " (" << m_PlanRigor
+     << ")" << std::endl;
+#  else
+  os << indent << "PlanRigor: " << m_PlanRigor << std::endl;
+#  endif
+  os << indent << "BatchSize: " << m_BatchSize << std::endl;
+  os << indent << "NumberOfPlanThreads: " << m_NumberOfPlanThreads << std::endl;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+  this->BeforeThreadedGenerateData();
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegionRestrictDirection<OutputImageType::ImageDimension>(
+    this->m_Direction,
+    this->GetOutput()->GetRequestedRegion(),
+    [this](const OutputImageRegionType & outputRegion) { this->DynamicThreadedGenerateData(outputRegion); },
+    this);
+
+  this->AfterThreadedGenerateData();
 }
 
 
@@ -82,97 +143,258 @@ FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateDa
 {
   Superclass::BeforeThreadedGenerateData();
 
-  this->m_ImageRegionSplitter->SetDirection(this->GetDirection());
-
   OutputImageType * outputPtr = this->GetOutput();
 
   const typename OutputImageType::SizeType & outputSize = outputPtr->GetRequestedRegion().GetSize();
   const unsigned int                         lineSize = outputSize[this->m_Direction];
+  // strided lines are batched a tile at a time, see fft1d::ForEachLineTile
+  const SizeValueType batchSize =
+    (this->m_Direction == 0) ? this->m_BatchSize : std::max(this->m_BatchSize, fft1d::MaximumLineTileSize);
+  // the non-negative frequencies are enough when the spectrum is Hermitian
+  const bool complexToReal = this->m_HalfSpectrum || this->m_HermitianInput;
 
   if (this->m_PlanComputed)
   {
-    // if the image sizes aren't the same,
-    // we have to comput the plan again
-    if (this->m_LastImageSize != lineSize)
+    // if the image sizes, the plan rigor, the batch size, the number of plan
+    // threads or the input spectrum layout aren't the same, we have to
+    // compute the plan again
+    if (this->m_LastImageSize != lineSize || this->m_LastPlanRigor != this->m_PlanRigor ||
+        this->m_LastBatchSize != batchSize || this->m_LastNumberOfPlanThreads != this->m_NumberOfPlanThreads ||
+        this->m_LastComplexToReal != complexToReal)
     {
       this->DestroyPlans();
     }
   }
   if (!this->m_PlanComputed)
   {
-    const int threads = this->GetNumberOfWorkUnits();
-    m_PlanArray.resize(threads);
-    m_InputBufferArray.resize(threads);
-    m_OutputBufferArray.resize(threads);
-    for (int i = 0; i < threads; i++)
-    {
-      try
-      {
-        m_InputBufferArray[i] = new typename FFTW1DProxyType::ComplexType[lineSize];
-        m_OutputBufferArray[i] = new typename FFTW1DProxyType::ComplexType[lineSize];
-      }
-      catch (std::bad_alloc &)
-      {
-        itkExceptionMacro("Problem allocating memory for internal computations");
-      }
-      m_PlanArray[i] = FFTW1DProxyType::Plan_dft_1d(
-        lineSize, m_InputBufferArray[i], m_OutputBufferArray[i], FFTW_BACKWARD, FFTW_ESTIMATE, 1);
-    }
+    // the buffers and plans of the work units are created on demand
     this->m_LastImageSize = lineSize;
+    this->m_LastPlanRigor = this->m_PlanRigor;
+    this->m_LastBatchSize = batchSize;
+    this->m_LastNumberOfPlanThreads = this->m_NumberOfPlanThreads;
+    this->m_LastComplexToReal = complexToReal;
     this->m_PlanComputed = true;
   }
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+auto
+FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::CreateWorkBuffers() const -> std::unique_ptr<WorkBuffers>
+{
+  const unsigned int lineSize = this->m_LastImageSize;
+  // only the non-negative frequencies are transformed by the c2r plans
+  const unsigned int inputLineSize = this->m_LastComplexToReal ? lineSize / 2 + 1 : lineSize;
+
+  // the line buffers come from the scratch arena, aligned for the SIMD codelets
+  std::unique_ptr<WorkBuffers> buffers(new WorkBuffers);
+  try
+  {
+    buffers->InputBuffer.Allocate(inputLineSize * this->m_LastBatchSize);
+    buffers->OutputBuffer.Allocate(lineSize * this->m_LastBatchSize);
+  }
+  catch (std::bad_alloc &)
+  {
+    itkExceptionMacro("Problem allocating memory for internal computations");
+  }
+  // the plans are shared with the other filters through the plan cache
+  if (this->m_LastComplexToReal)
+  {
+    // the output buffer holds the real output lines
+    auto * realOutputBuffer = reinterpret_cast<typename FFTW1DProxyType::PixelType *>(buffers->OutputBuffer.data());
+    buffers->Plan = PlanCacheType::GetPlan(PlanCacheType::COMPLEX_TO_REAL,
+                                           lineSize,
+                                           1,
+                                           buffers->InputBuffer.data(),
+                                           inputLineSize,
+                                           realOutputBuffer,
+                                           lineSize,
+                                           this->m_LastPlanRigor,
+                                           this->m_LastNumberOfPlanThreads);
+    if (this->m_LastBatchSize > 1)
+    {
+      buffers->BatchPlan = PlanCacheType::GetPlan(PlanCacheType::COMPLEX_TO_REAL,
+                                                  lineSize,
+                                                  static_cast<int>(this->m_LastBatchSize),
+                                                  buffers->InputBuffer.data(),
+                                                  inputLineSize,
+                                                  realOutputBuffer,
+                                                  lineSize,
+                                                  this->m_LastPlanRigor,
+                                                  this->m_LastNumberOfPlanThreads);
+    }
+  }
+  else
+  {
+    buffers->Plan = PlanCacheType::GetPlan(PlanCacheType::BACKWARD,
+                                           lineSize,
+                                           1,
+                                           buffers->InputBuffer.data(),
+                                           lineSize,
+                                           buffers->OutputBuffer.data(),
+                                           lineSize,
+                                           this->m_LastPlanRigor,
+                                           this->m_LastNumberOfPlanThreads);
+    if (this->m_LastBatchSize > 1)
+    {
+      buffers->BatchPlan = PlanCacheType::GetPlan(PlanCacheType::BACKWARD,
+                                                  lineSize,
+                                                  static_cast<int>(this->m_LastBatchSize),
+                                                  buffers->InputBuffer.data(),
+                                                  lineSize,
+                                                  buffers->OutputBuffer.data(),
+                                                  lineSize,
+                                                  this->m_LastPlanRigor,
+                                                  this->m_LastNumberOfPlanThreads);
+    }
+  }
+  return buffers;
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 void
-FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const OutputImageRegionType & outputRegion,
-                                                                             ThreadIdType                  threadID)
+FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegion)
 {
   // get pointers to the input and output
   const InputImageType * inputPtr = this->GetInput();
   OutputImageType *      outputPtr = this->GetOutput();
 
-  const typename OutputImageType::SizeType & outputSize = outputPtr->GetRequestedRegion().GetSize();
-  const unsigned int                         lineSize = outputSize[this->m_Direction];
+  const unsigned int  direction = this->m_Direction;
+  const unsigned int  tileDimension = fft1d::GetLineTileDimension(direction);
+  const SizeValueType lineSize = this->m_LastImageSize;
+  const SizeValueType batchSize = this->m_LastBatchSize;
+  // the input lines are shorter than the output ones in HalfSpectrum mode,
+  // both start at the same index along the direction; the c2r plans only read
+  // the non-negative frequencies of the full spectrum lines
+  const SizeValueType inputLineSize =
+    this->m_LastComplexToReal ? lineSize / 2 + 1 : inputPtr->GetRequestedRegion().GetSize(direction);
 
-  using InputIteratorType = itk::ImageLinearConstIteratorWithIndex<InputImageType>;
-  using OutputIteratorType = itk::ImageLinearIteratorWithIndex<OutputImageType>;
-  InputIteratorType  inputIt(inputPtr, outputRegion);
-  OutputIteratorType outputIt(outputPtr, outputRegion);
+  using RealType = typename FFTW1DProxyType::PixelType;
+  using ComplexType = typename FFTW1DProxyType::ComplexType;
+  using InputPixelType = typename InputImageType::PixelType;
+  using IndexType = typename OutputImageType::IndexType;
 
-  inputIt.SetDirection(this->m_Direction);
-  outputIt.SetDirection(this->m_Direction);
+  // the 1/N normalization is a multiplication, unless it is turned off
+  const RealType scale = this->m_Normalize ? RealType(1) / static_cast<RealType>(lineSize) : RealType(1);
 
-  typename InputIteratorType::PixelType * inputBufferIt;
-  typename FFTW1DProxyType::ComplexType * outputBufferIt;
+  std::vector<IndexType> lineStarts;
+  lineStarts.reserve(batchSize);
 
-  // for every fft line
-  for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); outputIt.NextLine(), inputIt.NextLine())
-  {
-    // copy the input line into our buffer
-    inputIt.GoToBeginOfLine();
-    inputBufferIt = reinterpret_cast<typename InputIteratorType::PixelType *>(m_InputBufferArray[threadID]);
-    while (!inputIt.IsAtEndOfLine())
+  // use a set of line buffers of the pool for this work unit
+  typename WorkBufferPoolType::BuffersPointer buffers =
+    m_WorkBufferPool.CheckOut([this]() { return this->CreateWorkBuffers(); });
+
+  // transform lines adjacent along the tile dimension with a single plan
+  // execution
+  const auto transformLines = [&](const IndexType & firstLineStart, const SizeValueType lines) {
+    lineStarts.clear();
+    if (direction == 0)
+    {
+      for (SizeValueType line = 0; line < lines; ++line)
+      {
+        IndexType lineStart = firstLineStart;
+        if (line > 0)
+        {
+          lineStart[tileDimension] += static_cast<IndexValueType>(line);
+        }
+        lineStarts.push_back(lineStart);
+      }
+    }
+
+    // transform straight from the input buffer when the lines are stored back
+    // to back and the alignment is the one the plan was created with; the
+    // out-of-place complex plans preserve their input, but the c2r plans of
+    // the HalfSpectrum mode do not
+    ComplexType * inputBuffer = buffers->InputBuffer.data();
+    ComplexType * inputLines = nullptr;
+    if (!this->m_LastComplexToReal)
+    {
+      inputLines = const_cast<ComplexType *>(
+        reinterpret_cast<const ComplexType *>(fft1d::ContiguousLines(inputPtr, lineStarts, inputLineSize, direction)));
+    }
+    if (inputLines != nullptr && FFTW1DProxyType::AlignmentOf(inputLines) == FFTW1DProxyType::AlignmentOf(inputBuffer))
+    {
+      inputBuffer = inputLines;
+    }
+    else
     {
-      *inputBufferIt = inputIt.Get();
-      ++inputIt;
-      ++inputBufferIt;
+      // copy the input lines into our buffer
+      fft1d::GatherLineTile(
+        inputPtr, firstLineStart, direction, inputLineSize, lines, reinterpret_cast<InputPixelType *>(inputBuffer));
     }
 
-    // do the transform
-    FFTW1DProxyType::Execute(m_PlanArray[threadID]);
+    const typename FFTW1DProxyType::PlanType plan = (lines > 1) ? buffers->BatchPlan->Get() : buffers->Plan->Get();
+    RealType *                               outputBuffer = reinterpret_cast<RealType *>(buffers->OutputBuffer.data());
+    RealType *                               outputLines = nullptr;
+    if (this->m_LastComplexToReal)
+    {
+      // the c2r plans write the real lines straight into the output buffer
+      // when they are stored back to back
+      outputLines = fft1d::ContiguousLines(outputPtr, lineStarts, lineSize, direction);
+      if (outputLines != nullptr &&
+          FFTW1DProxyType::AlignmentOf(outputLines) == FFTW1DProxyType::AlignmentOf(outputBuffer))
+      {
+        outputBuffer = outputLines;
+      }
+
+      // do the transform
+      FFTW1DProxyType::Execute_dft_c2r(plan, inputBuffer, outputBuffer);
+
+      // normalize the lines
+      if (this->m_Normalize)
+      {
+        const SizeValueType numberOfValues = lines * lineSize;
+        for (SizeValueType ii = 0; ii < numberOfValues; ++ii)
+        {
+          outputBuffer[ii] *= scale;
+        }
+      }
+    }
+    else
+    {
+      // do the transform
+      FFTW1DProxyType::Execute_dft(plan, inputBuffer, buffers->OutputBuffer.data());
+
+      // pack the normalized real parts at the beginning of the buffer; each
+      // value is read before it is overwritten
+      const ComplexType * complexOutputBuffer = buffers->OutputBuffer.data();
+      const SizeValueType numberOfValues = lines * lineSize;
+      for (SizeValueType ii = 0; ii < numberOfValues; ++ii)
+      {
+        outputBuffer[ii] = complexOutputBuffer[ii][0] * scale;
+      }
+    }
 
-    // copy the output from the buffer into our line
-    outputBufferIt = m_OutputBufferArray[threadID];
-    outputIt.GoToBeginOfLine();
-    while (!outputIt.IsAtEndOfLine())
+    if (outputBuffer != outputLines)
     {
-      outputIt.Set((*outputBufferIt)[0] / lineSize);
-      ++outputIt;
-      ++outputBufferIt;
+      // copy the output from the buffer into our lines
+      fft1d::ScatterLineTile(outputPtr, firstLineStart, direction, lineSize, lines, outputBuffer);
     }
-  }
+  };
+
+  // for every tile of fft lines
+  fft1d::ForEachLineTile(
+    outputRegion, direction, batchSize, [&](const IndexType & tileStart, const SizeValueType numberOfLines) {
+      if (numberOfLines == batchSize)
+      {
+        transformLines(tileStart, batchSize);
+        return;
+      }
+      // remaining lines are transformed one at a time
+      IndexType lineStart = tileStart;
+      for (SizeValueType line = 0; line < numberOfLines; ++line)
+      {
+        if (line > 0)
+        {
+          ++lineStart[tileDimension];
+        }
+        transformLines(lineStart, 1);
+      }
+    });
+
+  m_WorkBufferPool.CheckIn(std::move(buffers));
 }
 
 } // namespace itk
@@ -19,20 +19,43 @@
 #define itkForward1DFFTImageFilter_h
 
 #include <complex>
+#include <type_traits>
 
+#include "itkFFT1DBackendRegistry.h"
 #include "itkImageToImageFilter.h"
 
 namespace itk
 {
+namespace fft1d
+{
+/** Precision of the transform of real input pixels of type TPixel. Integer
+ * pixels, such as the int16 samples of RF digitizers, are transformed in
+ * float when float holds them exactly, in double otherwise. */
+template <typename TPixel>
+struct RealFFTPrecision
+{
+  using Type = typename std::conditional<std::is_integral<TPixel>::value,
+                                         typename std::conditional<(sizeof(TPixel) <= 2), float, double>::type,
+                                         TPixel>::type;
+};
+} // end namespace fft1d
+
 /** \class Forward1DFFTImageFilter
  * \brief Perform the Fast Fourier Transform, in the forward direction, with
  * real inputs, but only along one dimension.
  *
+ * The input pixels may be integers: they are converted to the precision of
+ * the output pixels while the lines are copied into the transform buffers,
+ * without an intermediate floating point image. The default output pixel
+ * precision is given by fft1d::RealFFTPrecision.
+ *
  * \ingroup FourierTransform
  * \ingroup Ultrasound
  */
 template <typename TInputImage,
-          typename TOutputImage = Image<std::complex<typename TInputImage::PixelType>, TInputImage::ImageDimension>>
+          typename TOutputImage =
+            Image<std::complex<typename fft1d::RealFFTPrecision<typename TInputImage::PixelType>::Type>,
+                  TInputImage::ImageDimension>>
 class ITK_TEMPLATE_EXPORT Forward1DFFTImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
 {
 public:
@@ -55,17 +78,71 @@ public:
   /** Customized object creation methods that support configuration-based
    * selection of FFT implementation.
    *
-   * Default implementation is VnlFFT1D.
+   * Default implementation is FFTW when available, NativeFFT1D otherwise.
+   * The backend set in fft1d::BackendRegistry, at run time or with the
+   * ITKUltrasound_FFT1D_BACKEND environment variable, overrides the default.
+   * AUTO_TUNE needs the size of the lines and creates the default
+   * implementation here, with a warning the first time.
    */
   static Pointer
   New();
 
+  using BackendType = fft1d::BackendRegistry::BackendType;
+
+  /** Create the filter of a given backend. Returns a null pointer when the
+   * backend is not available in this build or for this pixel type. DEFAULT
+   * and AUTO_TUNE create the default implementation. */
+  static Pointer
+  New(BackendType backend);
+
+  /** Create the filter of the fft1d::BackendRegistry backend for
+   * numberOfLines lines of lineSize pixels along direction, which is set as
+   * the Direction of the filter. With AUTO_TUNE, this is the backend that
+   * transformed such lines the fastest, timed on the first call for the size
+   * and direction. */
+  static Pointer
+  New(SizeValueType lineSize, SizeValueType numberOfLines, unsigned int direction = 0);
+
   /** Get the direction in which the filter is to be applied. */
   itkGetMacro(Direction, unsigned int);
 
   /** Set the direction in which the filter is to be applied. */
   itkSetClampMacro(Direction, unsigned int, 0, ImageDimension - 1);
 
+  /** Set/Get whether the output only holds the non-negative frequency half
+   * of the spectrum, lineSize / 2 + 1 bins along Direction, instead of all
+   * lineSize bins. The spectrum of a real signal is Hermitian, so the other
+   * half is the complex conjugate of this one and can be recovered by
+   * Inverse1DFFTImageFilter with its HalfSpectrum option on. The input line
+   * size is recorded as a SizeValueType under the "FFT1DLineSize" key of the
+   * output meta data dictionary. Default is false. */
+  itkSetMacro(HalfSpectrum, bool);
+  itkGetConstMacro(HalfSpectrum, bool);
+  itkBooleanMacro(HalfSpectrum);
+
+  /** Set/Get the size of the transformed lines, when the input lines are to
+   * be zero padded: the input line size is then the valid input length, the
+   * output lines hold the spectrum of the lines padded to PaddedLineSize, and
+   * the padding is neither copied nor stored. The native transforms skip the
+   * zeros in their first stage. A value not greater than the input line size,
+   * such as the default 0, transforms lines of the input size. */
+  itkSetMacro(PaddedLineSize, SizeValueType);
+  itkGetConstMacro(PaddedLineSize, SizeValueType);
+
+  /** Set/Get a band of contiguous bins of the spectrum to keep in the output:
+   * when NumberOfFrequencyBins is not 0, the output lines only hold the bins
+   * FirstFrequencyBin to FirstFrequencyBin + NumberOfFrequencyBins - 1 of the
+   * spectrum of the transformed lines, and HalfSpectrum is ignored. The bins
+   * over half the line size are the negative frequencies. The native backend
+   * only computes the band, with Goertzel's algorithm for a few bins and with
+   * an output-pruned FFT otherwise; the other backends compute the whole
+   * spectrum and only store the band. Default is 0 bins, the whole
+   * spectrum. */
+  itkSetMacro(FirstFrequencyBin, SizeValueType);
+  itkGetConstMacro(FirstFrequencyBin, SizeValueType);
+  itkSetMacro(NumberOfFrequencyBins, SizeValueType);
+  itkGetConstMacro(NumberOfFrequencyBins, SizeValueType);
+
   /** Get the greatest supported prime factor. */
   virtual SizeValueType
   GetSizeGreatestPrimeFactor() const
@@ -80,15 +157,42 @@ protected:
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
+  void
+  GenerateOutputInformation() override;
   void
   GenerateInputRequestedRegion() override;
   void
   EnlargeOutputRequestedRegion(DataObject * output) override;
 
+  /** Size of the transformed lines: the input line size, or PaddedLineSize
+   * when it is greater. */
+  SizeValueType
+  GetTransformLineSize() const;
+
+  /** First bin of the spectrum held by the output lines. */
+  SizeValueType
+  GetFirstOutputBin() const
+  {
+    return (this->m_NumberOfFrequencyBins > 0) ? this->m_FirstFrequencyBin : 0;
+  }
+
+  /** Number of leading bins of the spectrum to compute before the output bins
+   * are copied: the non-negative frequencies, GetTransformLineSize() / 2 + 1
+   * bins, when the output bins are among them, all the bins otherwise. */
+  SizeValueType
+  GetComputedSpectrumSize() const;
+
 private:
   /** Direction in which the filter is to be applied
    * this should be in the range [0,ImageDimension-1]. */
   unsigned int m_Direction;
+
+  bool m_HalfSpectrum;
+
+  SizeValueType m_PaddedLineSize;
+
+  SizeValueType m_FirstFrequencyBin;
+  SizeValueType m_NumberOfFrequencyBins;
 };
 } // namespace itk
 
@@ -97,7 +201,11 @@ private:
 #    ifndef itkVnlForward1DFFTImageFilter_hxx
 #      ifndef itkFFTWForward1DFFTImageFilter_h
 #        ifndef itkFFTWForward1DFFTImageFilter_hxx
-#          include "itkForward1DFFTImageFilter.hxx"
+#          ifndef itkNativeForward1DFFTImageFilter_h
+#            ifndef itkNativeForward1DFFTImageFilter_hxx
+#              include "itkForward1DFFTImageFilter.hxx"
+#            endif
+#          endif
 #        endif
 #      endif
 #    endif
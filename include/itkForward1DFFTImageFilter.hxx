@@ -20,6 +20,7 @@
 
 #include "itkForward1DFFTImageFilter.h"
 
+#include "itkNativeForward1DFFTImageFilter.h"
 #include "itkVnlForward1DFFTImageFilter.h"
 
 #if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
@@ -32,6 +33,8 @@
 
 #include "itkMetaDataObject.h"
 
+#include <algorithm>
+
 namespace itk
 {
 #ifdef ITKUltrasound_USE_clFFT
@@ -46,8 +49,8 @@ struct Dispatch_1DRealToComplexConjugate_New
 };
 #else
 
-template<typename TInputImage, typename TOutputImage>
-class VnlForward1DFFTImageFilter;
+template <typename TInputImage, typename TOutputImage>
+class NativeForward1DFFTImageFilter;
 
 template <typename TSelfPointer, typename TInputImage, typename TOutputImage, typename TPixel>
 struct Dispatch_1DRealToComplexConjugate_New
@@ -55,7 +58,7 @@ struct Dispatch_1DRealToComplexConjugate_New
   static TSelfPointer
   Apply()
   {
-    return VnlForward1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+    return NativeForward1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
   }
 };
 
@@ -85,6 +88,41 @@ struct Dispatch_1DRealToComplexConjugate_New<TSelfPointer, TInputImage, TOutputI
 
 #endif // ITKUltrasound_USE_clFFT
 
+// FFTW filter when FFTW is available for the pixel precision, null otherwise
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage, typename TPixel>
+struct Dispatch_1DRealToComplexConjugate_FFTW_New
+{
+  static TSelfPointer
+  Apply()
+  {
+    return nullptr;
+  }
+};
+
+#ifdef ITK_USE_FFTWD
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage>
+struct Dispatch_1DRealToComplexConjugate_FFTW_New<TSelfPointer, TInputImage, TOutputImage, double>
+{
+  static TSelfPointer
+  Apply()
+  {
+    return FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+  }
+};
+#endif
+
+#ifdef ITK_USE_FFTWF
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage>
+struct Dispatch_1DRealToComplexConjugate_FFTW_New<TSelfPointer, TInputImage, TOutputImage, float>
+{
+  static TSelfPointer
+  Apply()
+  {
+    return FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+  }
+};
+#endif
+
 template <typename TInputImage, typename TOutputImage>
 typename Forward1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
 Forward1DFFTImageFilter<TInputImage, TOutputImage>::New()
@@ -93,23 +131,157 @@ Forward1DFFTImageFilter<TInputImage, TOutputImage>::New()
 
   if (smartPtr.IsNull())
   {
-    smartPtr = Dispatch_1DRealToComplexConjugate_New<
-      Pointer,
-      TInputImage,
-      TOutputImage,
-      typename NumericTraits<typename TOutputImage::PixelType>::ValueType>::Apply();
+    smartPtr = New(fft1d::BackendRegistry::GetUntunedBackend());
+  }
+  if (smartPtr.IsNull())
+  {
+    smartPtr = New(fft1d::BackendRegistry::DEFAULT);
   }
 
   return smartPtr;
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+typename Forward1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
+Forward1DFFTImageFilter<TInputImage, TOutputImage>::New(BackendType backend)
+{
+  using ValueType = typename NumericTraits<typename TOutputImage::PixelType>::ValueType;
+
+  switch (backend)
+  {
+    case fft1d::BackendRegistry::VNL:
+      return VnlForward1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+    case fft1d::BackendRegistry::FFTW:
+      return Dispatch_1DRealToComplexConjugate_FFTW_New<Pointer, TInputImage, TOutputImage, ValueType>::Apply();
+    case fft1d::BackendRegistry::NATIVE:
+      return NativeForward1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+    case fft1d::BackendRegistry::OPENCL:
+#ifdef ITKUltrasound_USE_clFFT
+      return OpenCLForward1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+#else
+      return nullptr;
+#endif
+    default:
+      return Dispatch_1DRealToComplexConjugate_New<Pointer, TInputImage, TOutputImage, ValueType>::Apply();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+typename Forward1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
+Forward1DFFTImageFilter<TInputImage, TOutputImage>::New(SizeValueType lineSize,
+                                                        SizeValueType numberOfLines,
+                                                        unsigned int  direction)
+{
+  using RegistryType = fft1d::BackendRegistry;
+  using ValueType = typename NumericTraits<typename TOutputImage::PixelType>::ValueType;
+
+  Pointer smartPtr = ObjectFactory<Self>::Create();
+
+  if (smartPtr.IsNull())
+  {
+    BackendType backend = RegistryType::GetBackend();
+    if (backend == RegistryType::AUTO_TUNE)
+    {
+      const auto timeBackend = [lineSize, numberOfLines, direction](BackendType candidate) -> double {
+        Pointer filter = New(candidate);
+        if (filter.IsNull())
+        {
+          return -1.0;
+        }
+        filter->SetDirection(direction);
+        const typename InputImageType::Pointer input =
+          RegistryType::MakeTuningImage<InputImageType>(lineSize, numberOfLines, direction);
+        return RegistryType::TimeFilter(filter.GetPointer(), input.GetPointer());
+      };
+      backend = RegistryType::GetTunedBackend<ValueType>(
+        RegistryType::REAL_TO_COMPLEX, lineSize, numberOfLines, direction, timeBackend);
+    }
+    smartPtr = New(backend);
+  }
+  if (smartPtr.IsNull())
+  {
+    smartPtr = New(RegistryType::DEFAULT);
+  }
+  smartPtr->SetDirection(direction);
+
+  return smartPtr;
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 Forward1DFFTImageFilter<TInputImage, TOutputImage>::Forward1DFFTImageFilter()
   : m_Direction(0)
+  , m_HalfSpectrum(false)
+  , m_PaddedLineSize(0)
+  , m_FirstFrequencyBin(0)
+  , m_NumberOfFrequencyBins(0)
 {}
 
 
+template <typename TInputImage, typename TOutputImage>
+SizeValueType
+Forward1DFFTImageFilter<TInputImage, TOutputImage>::GetTransformLineSize() const
+{
+  const InputImageType * input = this->GetInput();
+  const SizeValueType    inputLineSize = input->GetLargestPossibleRegion().GetSize(this->m_Direction);
+  return std::max(inputLineSize, this->m_PaddedLineSize);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+SizeValueType
+Forward1DFFTImageFilter<TInputImage, TOutputImage>::GetComputedSpectrumSize() const
+{
+  const SizeValueType lineSize = this->GetTransformLineSize();
+  const SizeValueType halfSize = lineSize / 2 + 1;
+  if (this->m_NumberOfFrequencyBins > 0)
+  {
+    return (this->m_FirstFrequencyBin + this->m_NumberOfFrequencyBins <= halfSize) ? halfSize : lineSize;
+  }
+  return this->m_HalfSpectrum ? halfSize : lineSize;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+Forward1DFFTImageFilter<TInputImage, TOutputImage>::GenerateOutputInformation()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+
+  if (!input || !output)
+  {
+    return;
+  }
+
+  const SizeValueType lineSize = this->GetTransformLineSize();
+  EncapsulateMetaData<SizeValueType>(output->GetMetaDataDictionary(), "FFT1DLineSize", lineSize);
+
+  // the zero padded lines are longer than the input ones, and only the
+  // non-negative frequencies are kept in HalfSpectrum mode, only the band
+  // when there is one
+  SizeValueType outputLineSize = this->m_HalfSpectrum ? lineSize / 2 + 1 : lineSize;
+  if (this->m_NumberOfFrequencyBins > 0)
+  {
+    const SizeValueType bandEnd = this->m_FirstFrequencyBin + this->m_NumberOfFrequencyBins;
+    if (bandEnd > lineSize)
+    {
+      itkExceptionMacro("Frequency bins " << this->m_FirstFrequencyBin << " to " << bandEnd - 1 << " outside of the "
+                                          << lineSize << " bins of the spectrum");
+    }
+    outputLineSize = this->m_NumberOfFrequencyBins;
+  }
+  typename OutputImageType::RegionType outputLargestRegion = output->GetLargestPossibleRegion();
+  outputLargestRegion.SetSize(this->m_Direction, outputLineSize);
+  output->SetLargestPossibleRegion(outputLargestRegion);
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 void
 Forward1DFFTImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
@@ -180,6 +352,10 @@ Forward1DFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os,
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Direction: " << m_Direction << std::endl;
+  os << indent << "HalfSpectrum: " << m_HalfSpectrum << std::endl;
+  os << indent << "PaddedLineSize: " << m_PaddedLineSize << std::endl;
+  os << indent << "FirstFrequencyBin: " << m_FirstFrequencyBin << std::endl;
+  os << indent << "NumberOfFrequencyBins: " << m_NumberOfFrequencyBins << std::endl;
 }
 
 } // end namespace itk
@@ -67,6 +67,7 @@ public:
   {
     m_FilterFunction = function;
   };
+  itkGetModifiableObjectMacro(FilterFunction, FrequencyDomain1DFilterFunction);
 
 protected:
   FrequencyDomain1DImageFilter();
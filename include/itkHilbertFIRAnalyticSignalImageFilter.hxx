@@ -0,0 +1,204 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkHilbertFIRAnalyticSignalImageFilter_hxx
+#define itkHilbertFIRAnalyticSignalImageFilter_hxx
+
+#include "itkHilbertFIRAnalyticSignalImageFilter.h"
+
+#include "itkFFT1DLineBatch.h"
+#include "itkFFT1DScratchArena.h"
+#include "itkMath.h"
+#include "itkNativeFFTSIMD.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+HilbertFIRAnalyticSignalImageFilter<TInputImage, TOutputImage>::HilbertFIRAnalyticSignalImageFilter()
+{
+  this->DynamicMultiThreadingOn();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+HilbertFIRAnalyticSignalImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Direction: " << m_Direction << std::endl;
+  os << indent << "KernelRadius: " << m_KernelRadius << std::endl;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+HilbertFIRAnalyticSignalImageFilter<TInputImage, TOutputImage>::ComputeTaps() const -> std::vector<RealType>
+{
+  // Blackman window over the 2 KernelRadius + 1 taps, nonzero at both ends
+  const double          windowRadius = m_KernelRadius + 1.0;
+  std::vector<RealType> taps;
+  for (unsigned int lag = 1; lag <= m_KernelRadius; lag += 2)
+  {
+    const double phase = Math::pi * lag / windowRadius;
+    const double window = 0.42 + 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+    taps.push_back(static_cast<RealType>(2.0 / (Math::pi * lag) * window));
+  }
+  return taps;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+HilbertFIRAnalyticSignalImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType *  input = const_cast<InputImageType *>(this->GetInput());
+  OutputImageType * output = this->GetOutput();
+
+  if (!input || !output)
+  {
+    return;
+  }
+
+  // only a halo of KernelRadius pixels is needed along the direction
+  typename InputImageType::SizeType haloRadius;
+  haloRadius.Fill(0);
+  haloRadius[m_Direction] = m_KernelRadius;
+  typename InputImageType::RegionType inputRequestedRegion = output->GetRequestedRegion();
+  inputRequestedRegion.PadByRadius(haloRadius);
+  inputRequestedRegion.Crop(input->GetLargestPossibleRegion());
+
+  input->SetRequestedRegion(inputRequestedRegion);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+HilbertFIRAnalyticSignalImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateData()
+{
+  m_Taps = this->ComputeTaps();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+HilbertFIRAnalyticSignalImageFilter<TInputImage, TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+  const unsigned int     direction = m_Direction;
+  const SizeValueType    radius = m_KernelRadius;
+
+  const typename InputImageType::RegionType & largestRegion = input->GetLargestPossibleRegion();
+
+  // the lines of the region, with their halo, zero outside the image
+  const SizeValueType  lineSize = outputRegionForThread.GetSize(direction);
+  const IndexValueType lineStart = outputRegionForThread.GetIndex(direction);
+  const IndexValueType haloStart = lineStart - static_cast<IndexValueType>(radius);
+  const IndexValueType haloEnd = lineStart + static_cast<IndexValueType>(lineSize + radius);
+  const IndexValueType imageStart = largestRegion.GetIndex(direction);
+  const IndexValueType imageEnd = imageStart + static_cast<IndexValueType>(largestRegion.GetSize(direction));
+  const IndexValueType inputStart = std::max(haloStart, imageStart);
+  const IndexValueType inputEnd = std::min(haloEnd, imageEnd);
+  const SizeValueType  paddedLineSize = lineSize + 2 * radius;
+
+  fft1d::ScratchBuffer<RealType>    inputBuffer(fft1d::MaximumLineTileSize * paddedLineSize);
+  fft1d::ScratchBuffer<RealType>    hilbertBuffer(lineSize);
+  fft1d::ScratchBuffer<ComplexType> outputBuffer(fft1d::MaximumLineTileSize * lineSize);
+  std::fill(inputBuffer.data(), inputBuffer.data() + inputBuffer.size(), RealType(0));
+
+  fft1d::ForEachLineTile(
+    outputRegionForThread,
+    direction,
+    fft1d::MaximumLineTileSize,
+    [&](const typename OutputImageType::IndexType & tileStart, SizeValueType numberOfLines) {
+      typename InputImageType::IndexType inputTileStart = tileStart;
+      inputTileStart[direction] = inputStart;
+      fft1d::GatherLineTile(input,
+                            inputTileStart,
+                            direction,
+                            static_cast<SizeValueType>(inputEnd - inputStart),
+                            numberOfLines,
+                            inputBuffer.data() + (inputStart - haloStart),
+                            paddedLineSize);
+
+      for (SizeValueType line = 0; line < numberOfLines; ++line)
+      {
+        const RealType * inputLine = inputBuffer.data() + line * paddedLineSize + radius;
+        ComplexType *    outputLine = outputBuffer.data() + line * lineSize;
+        this->FilterLine(inputLine, lineSize, hilbertBuffer.data());
+        for (SizeValueType k = 0; k < lineSize; ++k)
+        {
+          outputLine[k] = ComplexType(inputLine[k], hilbertBuffer[k]);
+        }
+      }
+
+      fft1d::ScatterLineTile(output, tileStart, direction, lineSize, numberOfLines, outputBuffer.data());
+    });
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+HilbertFIRAnalyticSignalImageFilter<TInputImage, TOutputImage>::FilterLine(const RealType * input,
+                                                                           SizeValueType    lineSize,
+                                                                           RealType *       output) const
+{
+  // a complex pack is used as 2 Width consecutive real values, with the
+  // antisymmetry of the taps folded in: output[k] is the sum over the odd
+  // lags of tap (input[k - lag] - input[k + lag])
+  using PackType = typename fft1d::WidestComplexPack<RealType>::Type;
+  constexpr SizeValueType valuesPerPack = 2 * PackType::Width;
+  const SizeValueType     numberOfTaps = m_Taps.size();
+  const RealType *        taps = m_Taps.data();
+
+  SizeValueType k = 0;
+  for (; k + valuesPerPack <= lineSize; k += valuesPerPack)
+  {
+    const RealType * center = input + k;
+    PackType         sum = (PackType::Load(center - 1) - PackType::Load(center + 1)).Scale(taps[0]);
+    for (SizeValueType tap = 1; tap < numberOfTaps; ++tap)
+    {
+      const SizeValueType lag = 2 * tap + 1;
+      sum = sum + (PackType::Load(center - lag) - PackType::Load(center + lag)).Scale(taps[tap]);
+    }
+    sum.Store(output + k);
+  }
+  for (; k < lineSize; ++k)
+  {
+    const RealType * center = input + k;
+    RealType         sum = (*(center - 1) - *(center + 1)) * taps[0];
+    for (SizeValueType tap = 1; tap < numberOfTaps; ++tap)
+    {
+      const SizeValueType lag = 2 * tap + 1;
+      sum = sum + (*(center - lag) - *(center + lag)) * taps[tap];
+    }
+    output[k] = sum;
+  }
+}
+
+} // end namespace itk
+
+#endif
@@ -20,6 +20,7 @@
 
 #include <complex>
 
+#include "itkFFT1DBackendRegistry.h"
 #include "itkImageToImageFilter.h"
 
 namespace itk
@@ -56,17 +57,74 @@ public:
   /** Customized object creation methods that support configuration-based
    * selection of FFT implementation.
    *
-   * Default implementation is VnlFFT1D.
+   * Default implementation is FFTW when available, NativeFFT1D otherwise.
+   * The backend set in fft1d::BackendRegistry, at run time or with the
+   * ITKUltrasound_FFT1D_BACKEND environment variable, overrides the default.
+   * AUTO_TUNE needs the size of the lines and creates the default
+   * implementation here, with a warning the first time.
    */
   static Pointer
   New(void);
 
+  using BackendType = fft1d::BackendRegistry::BackendType;
+
+  /** Create the filter of a given backend. Returns a null pointer when the
+   * backend is not available in this build or for this pixel type. DEFAULT
+   * and AUTO_TUNE create the default implementation. */
+  static Pointer
+  New(BackendType backend);
+
+  /** Create the filter of the fft1d::BackendRegistry backend for
+   * numberOfLines lines of lineSize pixels along direction, which is set as
+   * the Direction of the filter. With AUTO_TUNE, this is the backend that
+   * transformed such lines the fastest, timed on the first call for the size
+   * and direction. */
+  static Pointer
+  New(SizeValueType lineSize, SizeValueType numberOfLines, unsigned int direction = 0);
+
   /** Get the direction in which the filter is to be applied. */
   itkGetMacro(Direction, unsigned int);
 
   /** Set the direction in which the filter is to be applied. */
   itkSetClampMacro(Direction, unsigned int, 0, ImageDimension - 1);
 
+  /** Set/Get whether the input only holds the non-negative frequency half of
+   * the spectrum, as produced by Forward1DFFTImageFilter with its
+   * HalfSpectrum option on. The output line size is then read from the
+   * "FFT1DLineSize" entry of the input meta data dictionary when it is
+   * consistent with the input, and is 2 * (inputLineSize - 1), plus one when
+   * ActualLineSizeIsOdd is on, otherwise. Default is false. */
+  itkSetMacro(HalfSpectrum, bool);
+  itkGetConstMacro(HalfSpectrum, bool);
+  itkBooleanMacro(HalfSpectrum);
+
+  /** Set/Get whether the line size of the output is odd when it cannot be
+   * read from the input meta data dictionary in HalfSpectrum mode. Default is
+   * false. */
+  itkSetMacro(ActualLineSizeIsOdd, bool);
+  itkGetConstMacro(ActualLineSizeIsOdd, bool);
+  itkBooleanMacro(ActualLineSizeIsOdd);
+
+  /** Set/Get whether the full spectrum input lines are Hermitian, as the
+   * spectra of real lines computed by Forward1DFFTImageFilter, and filtered
+   * with real symmetric gains, are. Only their non-negative frequencies are
+   * then read, and transformed with a complex-to-real transform of about half
+   * the cost of the complex one. The negative frequencies are assumed to be
+   * the complex conjugates of the positive ones, whatever they actually are.
+   * Implied by HalfSpectrum. Default is false. */
+  itkSetMacro(HermitianInput, bool);
+  itkGetConstMacro(HermitianInput, bool);
+  itkBooleanMacro(HermitianInput);
+
+  /** Set/Get whether the output is divided by the line size, so that the
+   * filter inverts Forward1DFFTImageFilter. When off, the output is the
+   * unnormalized backward transform, the line size times the inverse, which
+   * saves a pass over the output when the caller scales it anyway. Default is
+   * true. */
+  itkSetMacro(Normalize, bool);
+  itkGetConstMacro(Normalize, bool);
+  itkBooleanMacro(Normalize);
+
   /** Get the greatest supported prime factor. */
   virtual SizeValueType
   GetSizeGreatestPrimeFactor() const
@@ -81,6 +139,8 @@ protected:
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
+  void
+  GenerateOutputInformation() override;
   void
   GenerateInputRequestedRegion() override;
   void
@@ -90,6 +150,11 @@ protected:
    * this should be in the range [0,ImageDimension-1]. */
   unsigned int m_Direction;
 
+  bool m_HalfSpectrum;
+  bool m_ActualLineSizeIsOdd;
+  bool m_HermitianInput;
+  bool m_Normalize;
+
 private:
 };
 } // namespace itk
@@ -99,7 +164,11 @@ private:
 #    ifndef itkVnlInverse1DFFTImageFilter_hxx
 #      ifndef itkFFTWInverse1DFFTImageFilter_h
 #        ifndef itkFFTWInverse1DFFTImageFilter_hxx
-#          include "itkInverse1DFFTImageFilter.hxx"
+#          ifndef itkNativeInverse1DFFTImageFilter_h
+#            ifndef itkNativeInverse1DFFTImageFilter_hxx
+#              include "itkInverse1DFFTImageFilter.hxx"
+#            endif
+#          endif
 #        endif
 #      endif
 #    endif
@@ -20,6 +20,7 @@
 
 #include "itkInverse1DFFTImageFilter.h"
 
+#include "itkNativeInverse1DFFTImageFilter.h"
 #include "itkVnlInverse1DFFTImageFilter.h"
 
 #if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
@@ -53,7 +54,7 @@ struct Dispatch_1DComplexConjugateToReal_New
   static TSelfPointer
   Apply()
   {
-    return VnlInverse1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+    return NativeInverse1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
   }
 };
 
@@ -84,6 +85,41 @@ struct Dispatch_1DComplexConjugateToReal_New<TSelfPointer, TInputImage, TOutputI
 
 #endif // ITKUltrasound_USE_clFFT
 
+// FFTW filter when FFTW is available for the pixel precision, null otherwise
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage, typename TPixel>
+struct Dispatch_1DComplexConjugateToReal_FFTW_New
+{
+  static TSelfPointer
+  Apply()
+  {
+    return nullptr;
+  }
+};
+
+#ifdef ITK_USE_FFTWD
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage>
+struct Dispatch_1DComplexConjugateToReal_FFTW_New<TSelfPointer, TInputImage, TOutputImage, double>
+{
+  static TSelfPointer
+  Apply()
+  {
+    return FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+  }
+};
+#endif
+
+#ifdef ITK_USE_FFTWF
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage>
+struct Dispatch_1DComplexConjugateToReal_FFTW_New<TSelfPointer, TInputImage, TOutputImage, float>
+{
+  static TSelfPointer
+  Apply()
+  {
+    return FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+  }
+};
+#endif
+
 template <typename TInputImage, typename TOutputImage>
 typename Inverse1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
 Inverse1DFFTImageFilter<TInputImage, TOutputImage>::New()
@@ -92,12 +128,80 @@ Inverse1DFFTImageFilter<TInputImage, TOutputImage>::New()
 
   if (smartPtr.IsNull())
   {
-    smartPtr = Dispatch_1DComplexConjugateToReal_New<
-      Pointer,
-      TInputImage,
-      TOutputImage,
-      typename NumericTraits<typename TOutputImage::PixelType>::ValueType>::Apply();
+    smartPtr = New(fft1d::BackendRegistry::GetUntunedBackend());
+  }
+  if (smartPtr.IsNull())
+  {
+    smartPtr = New(fft1d::BackendRegistry::DEFAULT);
+  }
+
+  return smartPtr;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+typename Inverse1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
+Inverse1DFFTImageFilter<TInputImage, TOutputImage>::New(BackendType backend)
+{
+  using ValueType = typename NumericTraits<typename TOutputImage::PixelType>::ValueType;
+
+  switch (backend)
+  {
+    case fft1d::BackendRegistry::VNL:
+      return VnlInverse1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+    case fft1d::BackendRegistry::FFTW:
+      return Dispatch_1DComplexConjugateToReal_FFTW_New<Pointer, TInputImage, TOutputImage, ValueType>::Apply();
+    case fft1d::BackendRegistry::NATIVE:
+      return NativeInverse1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+    case fft1d::BackendRegistry::OPENCL:
+#ifdef ITKUltrasound_USE_clFFT
+      return OpenCLInverse1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+#else
+      return nullptr;
+#endif
+    default:
+      return Dispatch_1DComplexConjugateToReal_New<Pointer, TInputImage, TOutputImage, ValueType>::Apply();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+typename Inverse1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
+Inverse1DFFTImageFilter<TInputImage, TOutputImage>::New(SizeValueType lineSize,
+                                                        SizeValueType numberOfLines,
+                                                        unsigned int  direction)
+{
+  using RegistryType = fft1d::BackendRegistry;
+  using ValueType = typename NumericTraits<typename TOutputImage::PixelType>::ValueType;
+
+  Pointer smartPtr = ObjectFactory<Self>::Create();
+
+  if (smartPtr.IsNull())
+  {
+    BackendType backend = RegistryType::GetBackend();
+    if (backend == RegistryType::AUTO_TUNE)
+    {
+      const auto timeBackend = [lineSize, numberOfLines, direction](BackendType candidate) -> double {
+        Pointer filter = New(candidate);
+        if (filter.IsNull())
+        {
+          return -1.0;
+        }
+        filter->SetDirection(direction);
+        const typename InputImageType::Pointer input =
+          RegistryType::MakeTuningImage<InputImageType>(lineSize, numberOfLines, direction);
+        return RegistryType::TimeFilter(filter.GetPointer(), input.GetPointer());
+      };
+      backend = RegistryType::GetTunedBackend<ValueType>(
+        RegistryType::COMPLEX_TO_REAL, lineSize, numberOfLines, direction, timeBackend);
+    }
+    smartPtr = New(backend);
   }
+  if (smartPtr.IsNull())
+  {
+    smartPtr = New(RegistryType::DEFAULT);
+  }
+  smartPtr->SetDirection(direction);
 
   return smartPtr;
 }
@@ -106,9 +210,44 @@ Inverse1DFFTImageFilter<TInputImage, TOutputImage>::New()
 template <typename TInputImage, typename TOutputImage>
 Inverse1DFFTImageFilter<TInputImage, TOutputImage>::Inverse1DFFTImageFilter()
   : m_Direction(0)
+  , m_HalfSpectrum(false)
+  , m_ActualLineSizeIsOdd(false)
+  , m_HermitianInput(false)
+  , m_Normalize(true)
 {}
 
 
+template <typename TInputImage, typename TOutputImage>
+void
+Inverse1DFFTImageFilter<TInputImage, TOutputImage>::GenerateOutputInformation()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+
+  if (!input || !output || !this->m_HalfSpectrum)
+  {
+    return;
+  }
+
+  // recover the full line size from the non-negative frequencies
+  const SizeValueType inputLineSize = input->GetLargestPossibleRegion().GetSize(this->m_Direction);
+  SizeValueType       lineSize = 2 * (inputLineSize - 1) + (this->m_ActualLineSizeIsOdd ? 1 : 0);
+  SizeValueType       recordedLineSize = 0;
+  if (ExposeMetaData<SizeValueType>(input->GetMetaDataDictionary(), "FFT1DLineSize", recordedLineSize) &&
+      recordedLineSize / 2 + 1 == inputLineSize)
+  {
+    lineSize = recordedLineSize;
+  }
+
+  typename OutputImageType::RegionType outputLargestRegion = output->GetLargestPossibleRegion();
+  outputLargestRegion.SetSize(this->m_Direction, lineSize);
+  output->SetLargestPossibleRegion(outputLargestRegion);
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 void
 Inverse1DFFTImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
@@ -184,6 +323,10 @@ Inverse1DFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os,
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Direction: " << m_Direction << std::endl;
+  os << indent << "HalfSpectrum: " << m_HalfSpectrum << std::endl;
+  os << indent << "ActualLineSizeIsOdd: " << m_ActualLineSizeIsOdd << std::endl;
+  os << indent << "HermitianInput: " << m_HermitianInput << std::endl;
+  os << indent << "Normalize: " << m_Normalize << std::endl;
 }
 
 } // end namespace itk
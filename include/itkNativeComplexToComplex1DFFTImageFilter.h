@@ -0,0 +1,87 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkNativeComplexToComplex1DFFTImageFilter_h
+#define itkNativeComplexToComplex1DFFTImageFilter_h
+
+#include "itkComplexToComplex1DFFTImageFilter.h"
+#include "itkNativeFFT1D.h"
+#include <complex>
+
+namespace itk
+{
+
+/** \class NativeComplexToComplex1DFFTImageFilter
+ *
+ * \brief Perform the FFT along one dimension of an image using the built-in
+ * SIMD kernels of fft1d::NativeFFT as a backend.
+ *
+ * This is the default backend when FFTW is not available. Any line size is
+ * supported, sizes with prime factors greater than GetSizeGreatestPrimeFactor()
+ * at a few times the cost through Bluestein's algorithm.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT NativeComplexToComplex1DFFTImageFilter
+  : public ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(NativeComplexToComplex1DFFTImageFilter);
+
+  /** Standard class type alias. */
+  using Self = NativeComplexToComplex1DFFTImageFilter;
+  using Superclass = ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using InputImageType = typename Superclass::InputImageType;
+  using OutputImageType = typename Superclass::OutputImageType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  using TransformDirectionType = typename Superclass::TransformDirectionType;
+
+  using RealType = typename NumericTraits<typename InputImageType::PixelType>::ValueType;
+  using FFTType = fft1d::NativeFFT<RealType>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(NativeComplexToComplex1DFFTImageFilter, ComplexToComplex1DFFTImageFilter);
+
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const override
+  {
+    return FFTType::GreatestPrimeFactor;
+  }
+
+protected:
+  NativeComplexToComplex1DFFTImageFilter() {}
+  virtual ~NativeComplexToComplex1DFFTImageFilter() {}
+
+  void
+  GenerateData() override;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkNativeComplexToComplex1DFFTImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,102 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkNativeComplexToComplex1DFFTImageFilter_hxx
+#define itkNativeComplexToComplex1DFFTImageFilter_hxx
+
+#include "itkNativeComplexToComplex1DFFTImageFilter.h"
+
+#include "itkComplexToComplex1DFFTImageFilter.hxx"
+#include "itkFFT1DLineBatch.h"
+#include "itkFFT1DScratchArena.h"
+#include "itkIndent.h"
+#include "itkMetaDataObject.h"
+#include "itkMacro.h"
+
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+void
+NativeComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+
+  // get pointers to the input and output
+  const typename Superclass::InputImageType * input = this->GetInput();
+  typename Superclass::OutputImageType *      output = this->GetOutput();
+
+  const typename Superclass::InputImageType::SizeType & inputSize = input->GetRequestedRegion().GetSize();
+
+  const unsigned int  direction = this->GetDirection();
+  const SizeValueType vectorSize = inputSize[direction];
+
+  // shared by the work units, see fft1d::ForEachLineTile
+  const FFTType fft(vectorSize);
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegionRestrictDirection<TOutputImage::ImageDimension>(
+    direction,
+    output->GetRequestedRegion(),
+    [this, input, output, direction, vectorSize, &fft](const typename OutputImageType::RegionType & lambdaRegion) {
+      using ComplexType = typename FFTType::ComplexType;
+
+      // buffers of a tile of lines, see fft1d::ForEachLineTile
+      fft1d::ScratchBuffer<ComplexType> inputBuffer(fft1d::MaximumLineTileSize * vectorSize);
+      fft1d::ScratchBuffer<ComplexType> outputBuffer(fft1d::MaximumLineTileSize * vectorSize);
+      fft1d::ScratchBuffer<ComplexType> workBuffer(fft.GetWorkSize());
+      const bool                        inverse = this->m_TransformDirection == Superclass::INVERSE;
+      const RealType                    scale = inverse ? RealType(1) / static_cast<RealType>(vectorSize) : RealType(1);
+
+      fft1d::ForEachLineTile(
+        lambdaRegion,
+        direction,
+        fft1d::MaximumLineTileSize,
+        [&](const typename OutputImageType::IndexType & tileStart, SizeValueType numberOfLines) {
+          fft1d::GatherLineTile(input, tileStart, direction, vectorSize, numberOfLines, inputBuffer.data());
+
+          for (SizeValueType line = 0; line < numberOfLines; ++line)
+          {
+            const ComplexType * inputLine = inputBuffer.data() + line * vectorSize;
+            ComplexType *       outputLine = outputBuffer.data() + line * vectorSize;
+
+            // do the transform
+            if (inverse)
+            {
+              fft.Backward(inputLine, outputLine, workBuffer.data());
+              for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+              {
+                outputLine[ii] *= scale;
+              }
+            }
+            else
+            {
+              fft.Forward(inputLine, outputLine, workBuffer.data());
+            }
+          }
+
+          fft1d::ScatterLineTile(output, tileStart, direction, vectorSize, numberOfLines, outputBuffer.data());
+        });
+    },
+    this);
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,999 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkNativeFFT1D_h
+#define itkNativeFFT1D_h
+
+#include "itkFFT1DFixedLengthKernels.h"
+#include "itkIntTypes.h"
+#include "itkMath.h"
+#include "itkNativeFFTSIMD.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace itk
+{
+namespace fft1d
+{
+
+/** \class NativeFFT
+ * \brief Complex 1D FFT of a fixed size, computed with the built-in kernels.
+ *
+ * The transform is a self-sorting (Stockham) mixed radix FFT: radix 8, 4 and 2
+ * stages for the powers of two in the size, followed by radix 3 and 5 stages.
+ * Each stage reads one buffer and writes the other in natural order, so no bit
+ * reversal pass is needed, and once the powers of two are done the butterflies
+ * of a stage work on runs of consecutive values, which are processed with the
+ * complex packs of the instruction set selected in itkNativeFFTSIMD.h.
+ *
+ * The power of two sizes from 8 to 512 are transformed with the unrolled
+ * kernels of FixedLengthFFT instead.
+ *
+ * Sizes with a prime factor greater than 5 are transformed with Bluestein's
+ * algorithm, which writes the transform as a circular convolution with a
+ * chirp, computed with FFTs of a size with small prime factors at least twice
+ * as large. Any size is supported that way, at a few times the cost of a
+ * size with small prime factors.
+ *
+ * The forward transform of a zero padded line can be computed from its
+ * non-zero values only: the first stage skips the butterfly inputs that are
+ * known zeros, and its butterflies with a single non-zero input reduce to the
+ * twiddle multiplications.
+ *
+ * The object is not modified by the transforms, so a single object can be
+ * shared by several threads as long as each one has its own work buffer.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TReal>
+class NativeFFT
+{
+public:
+  using RealType = TReal;
+  using ComplexType = std::complex<RealType>;
+
+  /** Greatest prime factor of the sizes transformed without Bluestein's
+   * algorithm. Padding the lines to such a size is the cheapest option. */
+  static constexpr SizeValueType GreatestPrimeFactor = 5;
+
+  /** Whether a transform of this size can be computed. All non-zero sizes
+   * can. */
+  static bool
+  IsSizeSupported(SizeValueType size)
+  {
+    return size > 0;
+  }
+
+  /** Whether a size has no prime factor greater than GreatestPrimeFactor, so
+   * that it is transformed without Bluestein's algorithm. */
+  static bool
+  HasSmallPrimeFactors(SizeValueType size)
+  {
+    if (size == 0)
+    {
+      return false;
+    }
+    for (SizeValueType factor : { 2, 3, 5 })
+    {
+      while (size % factor == 0)
+      {
+        size /= factor;
+      }
+    }
+    return size == 1;
+  }
+
+  explicit NativeFFT(SizeValueType size)
+    : m_Size(size)
+    , m_FixedLength(FixedLengthFFT<RealType>::IsLengthSupported(size))
+  {
+    if (m_FixedLength)
+    {
+      return;
+    }
+    if (!HasSmallPrimeFactors(size))
+    {
+      this->InitializeBluestein();
+      return;
+    }
+    SizeValueType remaining = size;
+    SizeValueType stride = 1;
+    for (unsigned int radix : { 8, 4, 2, 3, 5 })
+    {
+      while (remaining % radix == 0)
+      {
+        Stage stage;
+        stage.Radix = radix;
+        stage.Length = remaining;
+        stage.Stride = stride;
+        stage.TwiddleOffset = m_Twiddles.size();
+        const SizeValueType m = remaining / radix;
+        for (SizeValueType p = 0; p < m; ++p)
+        {
+          for (unsigned int r = 1; r < radix; ++r)
+          {
+            const double angle = -2.0 * Math::pi * static_cast<double>(r * p) / static_cast<double>(remaining);
+            m_Twiddles.emplace_back(static_cast<RealType>(std::cos(angle)), static_cast<RealType>(std::sin(angle)));
+          }
+        }
+        m_Stages.push_back(stage);
+        remaining = m;
+        stride *= radix;
+      }
+    }
+  }
+
+  SizeValueType
+  GetSize() const
+  {
+    return m_Size;
+  }
+
+  /** Number of complex values the work buffer of the transforms must hold:
+   * GetSize() unless Bluestein's algorithm is used. */
+  SizeValueType
+  GetWorkSize() const
+  {
+    if (m_BluesteinFFT)
+    {
+      return 2 * m_BluesteinFFT->GetSize() + m_BluesteinFFT->GetWorkSize();
+    }
+    return m_Size;
+  }
+
+  /** Forward transform, with the e^{-2 pi i jk/N} kernel. input and output
+   * must not overlap, and work must hold GetWorkSize() values. input is left
+   * untouched. */
+  void
+  Forward(const ComplexType * input, ComplexType * output, ComplexType * work) const
+  {
+    this->Transform<false>(input, m_Size, output, work);
+  }
+
+  /** Input-pruned forward transform of a line whose values from inputSize
+   * on are zeros, such as a zero padded line: only the first inputSize values
+   * of input are read. inputSize must not be greater than GetSize(). */
+  void
+  Forward(const ComplexType * input, SizeValueType inputSize, ComplexType * output, ComplexType * work) const
+  {
+    this->Transform<false>(input, inputSize, output, work);
+  }
+
+  /** Unnormalized backward transform, with the e^{+2 pi i jk/N} kernel. */
+  void
+  Backward(const ComplexType * input, ComplexType * output, ComplexType * work) const
+  {
+    this->Transform<true>(input, m_Size, output, work);
+  }
+
+private:
+  struct Stage
+  {
+    unsigned int  Radix;
+    SizeValueType Length;
+    SizeValueType Stride;
+    SizeValueType TwiddleOffset;
+  };
+
+  template <bool VInverse>
+  void
+  Transform(const ComplexType * input, SizeValueType inputSize, ComplexType * output, ComplexType * work) const
+  {
+    if (m_FixedLength)
+    {
+      if (inputSize < m_Size)
+      {
+        // the unrolled kernels read the whole line
+        std::copy(input, input + inputSize, work);
+        std::fill(work + inputSize, work + m_Size, ComplexType(0));
+        input = work;
+      }
+      if (VInverse)
+      {
+        FixedLengthFFT<RealType>::Backward(m_Size, input, output);
+      }
+      else
+      {
+        FixedLengthFFT<RealType>::Forward(m_Size, input, output);
+      }
+      return;
+    }
+    if (m_BluesteinFFT)
+    {
+      this->BluesteinTransform<VInverse>(input, inputSize, output, work);
+      return;
+    }
+    if (m_Stages.empty())
+    {
+      std::copy(input, input + inputSize, output);
+      std::fill(output + inputSize, output + m_Size, ComplexType(0));
+      return;
+    }
+    // Ping-pong between the output and work buffers so that the last stage
+    // writes to the output.
+    ComplexType * buffers[2] = { output, work };
+    if (m_Stages.size() % 2 == 0)
+    {
+      std::swap(buffers[0], buffers[1]);
+    }
+    const ComplexType * source = input;
+    for (SizeValueType ii = 0; ii < m_Stages.size(); ++ii)
+    {
+      ComplexType * destination = buffers[ii % 2];
+      if (ii == 0 && inputSize < m_Size)
+      {
+        this->RunPrunedStage<VInverse>(m_Stages[ii], source, inputSize, destination);
+      }
+      else
+      {
+        this->RunStage<VInverse>(m_Stages[ii], source, destination);
+      }
+      source = destination;
+    }
+  }
+
+  /** Set up Bluestein's algorithm:
+   *
+   *   X[k] = c[k] sum_j (x[j] c[j]) conj(c[k - j]),  c[m] = e^{-pi i m^2 / N}
+   *
+   * with the convolution computed by FFTs of the smallest size with small
+   * prime factors that is at least 2 N - 1. */
+  void
+  InitializeBluestein()
+  {
+    const SizeValueType n = m_Size;
+    SizeValueType       convolutionSize = 2 * n - 1;
+    while (!HasSmallPrimeFactors(convolutionSize))
+    {
+      ++convolutionSize;
+    }
+    m_BluesteinFFT.reset(new NativeFFT(convolutionSize));
+
+    m_Chirp.resize(n);
+    for (SizeValueType k = 0; k < n; ++k)
+    {
+      // k^2 modulo 2 N keeps the angle accurate for long lines
+      const auto   kk = static_cast<std::uint64_t>(k);
+      const double angle = -Math::pi * static_cast<double>((kk * kk) % (2 * static_cast<std::uint64_t>(n))) /
+                           static_cast<double>(n);
+      m_Chirp[k] = ComplexType(static_cast<RealType>(std::cos(angle)), static_cast<RealType>(std::sin(angle)));
+    }
+
+    // spectrum of the conjugate chirp, wrapped around for the negative
+    // indices, with the 1 / convolutionSize of the backward transform
+    std::vector<ComplexType> conjugateChirp(convolutionSize, ComplexType(0));
+    for (SizeValueType m = 0; m < n; ++m)
+    {
+      conjugateChirp[m] = std::conj(m_Chirp[m]);
+      if (m > 0)
+      {
+        conjugateChirp[convolutionSize - m] = std::conj(m_Chirp[m]);
+      }
+    }
+    m_ChirpSpectrum.resize(convolutionSize);
+    std::vector<ComplexType> work(m_BluesteinFFT->GetWorkSize());
+    m_BluesteinFFT->Forward(conjugateChirp.data(), m_ChirpSpectrum.data(), work.data());
+    const RealType scale = RealType(1) / static_cast<RealType>(convolutionSize);
+    for (ComplexType & value : m_ChirpSpectrum)
+    {
+      value *= scale;
+    }
+  }
+
+  /** The backward transform is the conjugate of the forward transform of the
+   * conjugate input. */
+  template <bool VInverse>
+  void
+  BluesteinTransform(const ComplexType * input,
+                     SizeValueType       inputSize,
+                     ComplexType *       output,
+                     ComplexType *       work) const
+  {
+    const SizeValueType n = m_Size;
+    const SizeValueType convolutionSize = m_BluesteinFFT->GetSize();
+    ComplexType *       signal = work;
+    ComplexType *       spectrum = work + convolutionSize;
+    ComplexType *       scratch = work + 2 * convolutionSize;
+    for (SizeValueType j = 0; j < inputSize; ++j)
+    {
+      signal[j] = (VInverse ? std::conj(input[j]) : input[j]) * m_Chirp[j];
+    }
+    std::fill(signal + inputSize, signal + convolutionSize, ComplexType(0));
+    m_BluesteinFFT->Forward(signal, spectrum, scratch);
+    for (SizeValueType k = 0; k < convolutionSize; ++k)
+    {
+      spectrum[k] *= m_ChirpSpectrum[k];
+    }
+    m_BluesteinFFT->Backward(spectrum, signal, scratch);
+    for (SizeValueType k = 0; k < n; ++k)
+    {
+      const ComplexType value = m_Chirp[k] * signal[k];
+      output[k] = VInverse ? std::conj(value) : value;
+    }
+  }
+
+  template <bool VInverse>
+  void
+  RunStage(const Stage & stage, const ComplexType * source, ComplexType * destination) const
+  {
+    using VectorPackType = typename WidestComplexPack<RealType>::Type;
+    using ScalarPackType = ScalarComplexPack<RealType>;
+    if (stage.Stride % VectorPackType::Width == 0)
+    {
+      this->RunStageWithPack<VInverse, VectorPackType>(stage, source, destination);
+    }
+    else
+    {
+      this->RunStageWithPack<VInverse, ScalarPackType>(stage, source, destination);
+    }
+  }
+
+  template <bool VInverse, typename TPack>
+  void
+  RunStageWithPack(const Stage & stage, const ComplexType * source, ComplexType * destination) const
+  {
+    switch (stage.Radix)
+    {
+      case 2:
+        this->RunButterflies<VInverse, TPack, 2>(stage, source, destination);
+        break;
+      case 3:
+        this->RunButterflies<VInverse, TPack, 3>(stage, source, destination);
+        break;
+      case 4:
+        this->RunButterflies<VInverse, TPack, 4>(stage, source, destination);
+        break;
+      case 5:
+        this->RunButterflies<VInverse, TPack, 5>(stage, source, destination);
+        break;
+      default:
+        this->RunButterflies<VInverse, TPack, 8>(stage, source, destination);
+        break;
+    }
+  }
+
+  /** One stage of radix VRadix: for each butterfly p and each of the Stride
+   * consecutive values q it applies to,
+   *
+   *   y[q + s (VRadix p + r)] = w_n^{rp} DFT_VRadix(x[q + s (p + m j)], j)[r]
+   *
+   * with n the stage length, m = n / VRadix and s the stride. */
+  template <bool VInverse, typename TPack, unsigned int VRadix>
+  void
+  RunButterflies(const Stage & stage, const ComplexType * source, ComplexType * destination) const
+  {
+    const SizeValueType m = stage.Length / VRadix;
+    const SizeValueType s = stage.Stride;
+    const auto *        x = reinterpret_cast<const RealType *>(source);
+    auto *              y = reinterpret_cast<RealType *>(destination);
+    const ComplexType * twiddles = m_Twiddles.data() + stage.TwiddleOffset;
+    TPack               a[VRadix];
+    for (SizeValueType p = 0; p < m; ++p)
+    {
+      const ComplexType * w = twiddles + p * (VRadix - 1);
+      for (SizeValueType q = 0; q < s; q += TPack::Width)
+      {
+        for (unsigned int j = 0; j < VRadix; ++j)
+        {
+          a[j] = TPack::Load(x + 2 * (q + s * (p + m * j)));
+        }
+        Butterfly<VInverse>(a);
+        a[0].Store(y + 2 * (q + s * VRadix * p));
+        for (unsigned int r = 1; r < VRadix; ++r)
+        {
+          const RealType imaginary = VInverse ? -w[r - 1].imag() : w[r - 1].imag();
+          const TPack    b = (p == 0) ? a[r] : a[r].Multiply(w[r - 1].real(), imaginary);
+          b.Store(y + 2 * (q + s * (VRadix * p + r)));
+        }
+      }
+    }
+  }
+
+  /** First stage of an input-pruned transform, whose input is zero from
+   * validSize on. The first stage has a stride of one, so the butterflies
+   * are run one at a time. */
+  template <bool VInverse>
+  void
+  RunPrunedStage(const Stage &       stage,
+                 const ComplexType * source,
+                 SizeValueType       validSize,
+                 ComplexType *       destination) const
+  {
+    switch (stage.Radix)
+    {
+      case 2:
+        this->RunPrunedButterflies<VInverse, 2>(stage, source, validSize, destination);
+        break;
+      case 3:
+        this->RunPrunedButterflies<VInverse, 3>(stage, source, validSize, destination);
+        break;
+      case 4:
+        this->RunPrunedButterflies<VInverse, 4>(stage, source, validSize, destination);
+        break;
+      case 5:
+        this->RunPrunedButterflies<VInverse, 5>(stage, source, validSize, destination);
+        break;
+      default:
+        this->RunPrunedButterflies<VInverse, 8>(stage, source, validSize, destination);
+        break;
+    }
+  }
+
+  /** RunButterflies with a stride of one, where the inputs x[p + m j] past
+   * validSize are zeros that are not read. A butterfly with a single non-zero
+   * input x[p] writes w_n^{rp} x[p]. */
+  template <bool VInverse, unsigned int VRadix>
+  void
+  RunPrunedButterflies(const Stage &       stage,
+                       const ComplexType * source,
+                       SizeValueType       validSize,
+                       ComplexType *       destination) const
+  {
+    using PackType = ScalarComplexPack<RealType>;
+    const SizeValueType m = stage.Length / VRadix;
+    const auto *        x = reinterpret_cast<const RealType *>(source);
+    auto *              y = reinterpret_cast<RealType *>(destination);
+    const ComplexType * twiddles = m_Twiddles.data() + stage.TwiddleOffset;
+    const PackType      zero = { RealType(0), RealType(0) };
+    PackType            a[VRadix];
+    for (SizeValueType p = 0; p < m; ++p)
+    {
+      const ComplexType * w = twiddles + p * (VRadix - 1);
+      unsigned int        nonZero = 0;
+      while (nonZero < VRadix && p + m * nonZero < validSize)
+      {
+        ++nonZero;
+      }
+      if (nonZero <= 1)
+      {
+        const PackType a0 = (nonZero == 1) ? PackType::Load(x + 2 * p) : zero;
+        a0.Store(y + 2 * VRadix * p);
+        for (unsigned int r = 1; r < VRadix; ++r)
+        {
+          const RealType imaginary = VInverse ? -w[r - 1].imag() : w[r - 1].imag();
+          const PackType b = (p == 0 || nonZero == 0) ? a0 : a0.Multiply(w[r - 1].real(), imaginary);
+          b.Store(y + 2 * (VRadix * p + r));
+        }
+        continue;
+      }
+      for (unsigned int j = 0; j < VRadix; ++j)
+      {
+        a[j] = (j < nonZero) ? PackType::Load(x + 2 * (p + m * j)) : zero;
+      }
+      Butterfly<VInverse>(a);
+      a[0].Store(y + 2 * VRadix * p);
+      for (unsigned int r = 1; r < VRadix; ++r)
+      {
+        const RealType imaginary = VInverse ? -w[r - 1].imag() : w[r - 1].imag();
+        const PackType b = (p == 0) ? a[r] : a[r].Multiply(w[r - 1].real(), imaginary);
+        b.Store(y + 2 * (VRadix * p + r));
+      }
+    }
+  }
+
+  /** In-place DFT of 2, 3, 4, 5 or 8 packs. */
+  template <bool VInverse, typename TPack>
+  static void
+  Butterfly(TPack (&a)[2])
+  {
+    const TPack t = a[0] - a[1];
+    a[0] = a[0] + a[1];
+    a[1] = t;
+  }
+
+  template <bool VInverse, typename TPack>
+  static void
+  Butterfly(TPack (&a)[3])
+  {
+    const RealType half = 0.5;
+    const RealType sin60 = 0.866025403784438646763723170752936183;
+    const TPack    sum = a[1] + a[2];
+    const TPack    difference = (a[1] - a[2]).Scale(sin60);
+    const TPack    middle = a[0] - sum.Scale(half);
+    // -i sin(60) (a1 - a2) for the forward transform
+    const TPack rotated = VInverse ? difference.MultiplyByI() : difference.MultiplyByMinusI();
+    a[0] = a[0] + sum;
+    a[1] = middle + rotated;
+    a[2] = middle - rotated;
+  }
+
+  template <bool VInverse, typename TPack>
+  static void
+  Butterfly(TPack (&a)[4])
+  {
+    const TPack t0 = a[0] + a[2];
+    const TPack t1 = a[0] - a[2];
+    const TPack t2 = a[1] + a[3];
+    const TPack t3 = VInverse ? (a[1] - a[3]).MultiplyByI() : (a[1] - a[3]).MultiplyByMinusI();
+    a[0] = t0 + t2;
+    a[1] = t1 + t3;
+    a[2] = t0 - t2;
+    a[3] = t1 - t3;
+  }
+
+  template <bool VInverse, typename TPack>
+  static void
+  Butterfly(TPack (&a)[5])
+  {
+    const RealType cos72 = 0.309016994374947424102293417182819059;
+    const RealType cos144 = -0.809016994374947424102293417182819059;
+    const RealType sin72 = 0.951056516295153572116439333379382143;
+    const RealType sin144 = 0.587785252292473129168705954639072769;
+    const TPack    t1 = a[1] + a[4];
+    const TPack    t2 = a[2] + a[3];
+    const TPack    t3 = a[1] - a[4];
+    const TPack    t4 = a[2] - a[3];
+    const TPack    m1 = a[0] + t1.Scale(cos72) + t2.Scale(cos144);
+    const TPack    m2 = a[0] + t1.Scale(cos144) + t2.Scale(cos72);
+    const TPack    n1 = t3.Scale(sin72) + t4.Scale(sin144);
+    const TPack    n2 = t3.Scale(sin144) - t4.Scale(sin72);
+    // -i n for the forward transform
+    const TPack rotated1 = VInverse ? n1.MultiplyByI() : n1.MultiplyByMinusI();
+    const TPack rotated2 = VInverse ? n2.MultiplyByI() : n2.MultiplyByMinusI();
+    a[0] = a[0] + t1 + t2;
+    a[1] = m1 + rotated1;
+    a[4] = m1 - rotated1;
+    a[2] = m2 + rotated2;
+    a[3] = m2 - rotated2;
+  }
+
+  template <bool VInverse, typename TPack>
+  static void
+  Butterfly(TPack (&a)[8])
+  {
+    const RealType sqrtHalf = 0.707106781186547524400844362104849039;
+    TPack          even[4] = { a[0], a[2], a[4], a[6] };
+    TPack          odd[4] = { a[1], a[3], a[5], a[7] };
+    Butterfly<VInverse>(even);
+    Butterfly<VInverse>(odd);
+    // Twiddles w_8^r, conjugated for the inverse transform
+    const RealType sign = VInverse ? 1 : -1;
+    odd[1] = odd[1].Multiply(sqrtHalf, sign * sqrtHalf);
+    odd[2] = VInverse ? odd[2].MultiplyByI() : odd[2].MultiplyByMinusI();
+    odd[3] = odd[3].Multiply(-sqrtHalf, sign * sqrtHalf);
+    for (unsigned int r = 0; r < 4; ++r)
+    {
+      a[r] = even[r] + odd[r];
+      a[r + 4] = even[r] - odd[r];
+    }
+  }
+
+  SizeValueType            m_Size;
+  bool                     m_FixedLength;
+  std::vector<Stage>       m_Stages;
+  std::vector<ComplexType> m_Twiddles;
+
+  std::unique_ptr<NativeFFT> m_BluesteinFFT;
+  std::vector<ComplexType>   m_Chirp;
+  std::vector<ComplexType>   m_ChirpSpectrum;
+};
+
+
+/** \class NativeRealFFT
+ * \brief Real 1D FFT of a fixed size, computed with the built-in kernels.
+ *
+ * Even sizes are transformed as a complex FFT of half the size, on the even
+ * and odd samples packed as real and imaginary parts, followed by a split
+ * pass; odd sizes fall back to a complex FFT of the full size.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TReal>
+class NativeRealFFT
+{
+public:
+  using RealType = TReal;
+  using ComplexType = std::complex<RealType>;
+  using ComplexFFTType = NativeFFT<RealType>;
+
+  explicit NativeRealFFT(SizeValueType size)
+    : m_Size(size)
+    , m_ComplexFFT(size % 2 == 0 ? size / 2 : size)
+  {
+    if (size % 2 == 0)
+    {
+      const SizeValueType half = size / 2;
+      m_SplitTwiddles.resize(half + 1);
+      for (SizeValueType k = 0; k <= half; ++k)
+      {
+        const double angle = -2.0 * Math::pi * static_cast<double>(k) / static_cast<double>(size);
+        m_SplitTwiddles[k] =
+          ComplexType(static_cast<RealType>(std::cos(angle)), static_cast<RealType>(std::sin(angle)));
+      }
+    }
+  }
+
+  SizeValueType
+  GetSize() const
+  {
+    return m_Size;
+  }
+
+  /** Number of complex values the work buffer of the transforms must hold. */
+  SizeValueType
+  GetWorkSize() const
+  {
+    return (m_Size % 2 == 0 ? m_Size : 2 * m_Size) + m_ComplexFFT.GetWorkSize();
+  }
+
+  /** Forward transform. Writes the GetSize() / 2 + 1 non-redundant bins of
+   * the spectrum to output. */
+  void
+  Forward(const RealType * input, ComplexType * output, ComplexType * work) const
+  {
+    this->Forward(input, m_Size, output, work);
+  }
+
+  /** Input-pruned forward transform of a line whose values from inputSize on
+   * are zeros: only the first inputSize values of input are read. */
+  void
+  Forward(const RealType * input, SizeValueType inputSize, ComplexType * output, ComplexType * work) const
+  {
+    const SizeValueType n = m_Size;
+    if (n % 2 != 0)
+    {
+      for (SizeValueType ii = 0; ii < inputSize; ++ii)
+      {
+        work[ii] = input[ii];
+      }
+      ComplexType * spectrum = work + n;
+      m_ComplexFFT.Forward(work, inputSize, spectrum, work + 2 * n);
+      std::copy(spectrum, spectrum + n / 2 + 1, output);
+      return;
+    }
+    const SizeValueType half = n / 2;
+    ComplexType *       packed = work;
+    ComplexType *       z = work + half;
+    const SizeValueType packedSize = inputSize / 2;
+    for (SizeValueType ii = 0; ii < packedSize; ++ii)
+    {
+      packed[ii] = ComplexType(input[2 * ii], input[2 * ii + 1]);
+    }
+    if (inputSize % 2 != 0)
+    {
+      packed[packedSize] = ComplexType(input[inputSize - 1], RealType(0));
+    }
+    m_ComplexFFT.Forward(packed, (inputSize + 1) / 2, z, work + n);
+    // X[k] = (Z[k] + conj(Z[h - k])) / 2 - i w^k (Z[k] - conj(Z[h - k])) / 2
+    for (SizeValueType k = 0; k <= half; ++k)
+    {
+      const ComplexType zk = z[k % half];
+      const ComplexType zc = std::conj(z[(half - k) % half]);
+      const ComplexType even = (zk + zc) * RealType(0.5);
+      const ComplexType odd = (zk - zc) * ComplexType(0, RealType(-0.5));
+      output[k] = even + m_SplitTwiddles[k] * odd;
+    }
+  }
+
+  /** Unnormalized backward transform from the GetSize() / 2 + 1 non-redundant
+   * bins of a Hermitian spectrum. input is left untouched. */
+  void
+  Backward(const ComplexType * input, RealType * output, ComplexType * work) const
+  {
+    const SizeValueType n = m_Size;
+    if (n % 2 != 0)
+    {
+      ComplexType * spectrum = work;
+      std::copy(input, input + n / 2 + 1, spectrum);
+      for (SizeValueType k = n / 2 + 1; k < n; ++k)
+      {
+        spectrum[k] = std::conj(input[n - k]);
+      }
+      ComplexType * signal = work + n;
+      m_ComplexFFT.Backward(spectrum, signal, work + 2 * n);
+      for (SizeValueType ii = 0; ii < n; ++ii)
+      {
+        output[ii] = signal[ii].real();
+      }
+      return;
+    }
+    const SizeValueType half = n / 2;
+    ComplexType *       packed = work;
+    ComplexType *       z = work + half;
+    // Z[k] = E[k] + i O[k] with E[k] = X[k] + conj(X[h - k]) and
+    // O[k] = conj(w^k) (X[k] - conj(X[h - k]))
+    for (SizeValueType k = 0; k < half; ++k)
+    {
+      const ComplexType xk = input[k];
+      const ComplexType xc = std::conj(input[half - k]);
+      const ComplexType odd = std::conj(m_SplitTwiddles[k]) * (xk - xc);
+      packed[k] = (xk + xc) + ComplexType(-odd.imag(), odd.real());
+    }
+    m_ComplexFFT.Backward(packed, z, work + n);
+    for (SizeValueType ii = 0; ii < half; ++ii)
+    {
+      output[2 * ii] = z[ii].real();
+      output[2 * ii + 1] = z[ii].imag();
+    }
+  }
+
+private:
+  SizeValueType            m_Size;
+  ComplexFFTType           m_ComplexFFT;
+  std::vector<ComplexType> m_SplitTwiddles;
+};
+
+
+/** \class NativeRealFFTBand
+ * \brief Contiguous band of bins of the spectrum of a real 1D line of a fixed
+ * size, computed without the rest of the spectrum.
+ *
+ * The bins FirstBin to FirstBin + NumberOfBins - 1 are computed with the
+ * cheapest of three algorithms, chosen from an operation count when the
+ * object is created:
+ *
+ * - Goertzel's algorithm, a second order real recursion per bin, for a few
+ *   bins;
+ * - an output-pruned FFT: the line of size N = P L is split into its P
+ *   decimated sub-lines x[p + P l], which are transformed two at a time with
+ *   complex FFTs of size L, and only the requested bins of the last radix P
+ *   step, X[k] = sum_p w^{pk} Y_p[k mod L], are computed;
+ * - the whole real FFT, from which the band is copied.
+ *
+ * As with NativeRealFFT, the object is not modified by the transforms.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TReal>
+class NativeRealFFTBand
+{
+public:
+  using RealType = TReal;
+  using ComplexType = std::complex<RealType>;
+
+  enum AlgorithmType
+  {
+    GOERTZEL = 0,
+    PRUNED_FFT,
+    FULL_FFT
+  };
+
+  /** firstBin + numberOfBins must not be greater than size. The bins over
+   * size / 2 are the negative frequencies. */
+  NativeRealFFTBand(SizeValueType size, SizeValueType firstBin, SizeValueType numberOfBins)
+    : m_Size(size)
+    , m_FirstBin(firstBin)
+    , m_NumberOfBins(numberOfBins)
+    , m_Algorithm(GOERTZEL)
+    , m_NumberOfSubLines(1)
+  {
+    // approximate floating point operation counts
+    const double n = static_cast<double>(size);
+    const double bins = static_cast<double>(numberOfBins);
+    double       cheapest = 4.0 * bins * n;
+    if (size > 1)
+    {
+      const double fullCost = 2.5 * n * std::log2(n) + 2.0 * n;
+      if (fullCost < cheapest)
+      {
+        cheapest = fullCost;
+        m_Algorithm = FULL_FFT;
+      }
+    }
+    for (SizeValueType subLines = 2; subLines < size; ++subLines)
+    {
+      const SizeValueType subLineSize = size / subLines;
+      if (size % subLines != 0 || !NativeFFT<RealType>::HasSmallPrimeFactors(subLineSize))
+      {
+        continue;
+      }
+      const double prunedCost = 2.5 * n * std::log2(static_cast<double>(subLineSize)) + 3.0 * n +
+                                8.0 * bins * static_cast<double>(subLines);
+      if (prunedCost < cheapest)
+      {
+        cheapest = prunedCost;
+        m_Algorithm = PRUNED_FFT;
+        m_NumberOfSubLines = subLines;
+      }
+    }
+
+    if (m_Algorithm == FULL_FFT)
+    {
+      m_RealFFT.reset(new NativeRealFFT<RealType>(size));
+    }
+    else if (m_Algorithm == PRUNED_FFT)
+    {
+      m_SubLineFFT.reset(new NativeFFT<RealType>(size / m_NumberOfSubLines));
+      m_Twiddles.resize(size);
+      for (SizeValueType k = 0; k < size; ++k)
+      {
+        const double angle = -2.0 * Math::pi * static_cast<double>(k) / n;
+        m_Twiddles[k] = ComplexType(static_cast<RealType>(std::cos(angle)), static_cast<RealType>(std::sin(angle)));
+      }
+    }
+  }
+
+  SizeValueType
+  GetSize() const
+  {
+    return m_Size;
+  }
+
+  SizeValueType
+  GetFirstBin() const
+  {
+    return m_FirstBin;
+  }
+
+  SizeValueType
+  GetNumberOfBins() const
+  {
+    return m_NumberOfBins;
+  }
+
+  AlgorithmType
+  GetAlgorithm() const
+  {
+    return m_Algorithm;
+  }
+
+  /** Number of complex values the work buffer of the transforms must hold. */
+  SizeValueType
+  GetWorkSize() const
+  {
+    switch (m_Algorithm)
+    {
+      case FULL_FFT:
+        return m_Size / 2 + 1 + m_RealFFT->GetWorkSize();
+      case PRUNED_FFT:
+        return m_Size + 2 * m_SubLineFFT->GetSize() + m_SubLineFFT->GetWorkSize();
+      default:
+        return 0;
+    }
+  }
+
+  /** Writes the GetNumberOfBins() bins of the band of the spectrum of a line
+   * whose values from inputSize on are zeros to output: only the first
+   * inputSize values of input are read. */
+  void
+  Forward(const RealType * input, SizeValueType inputSize, ComplexType * output, ComplexType * work) const
+  {
+    switch (m_Algorithm)
+    {
+      case FULL_FFT:
+      {
+        const SizeValueType half = m_Size / 2;
+        ComplexType *       spectrum = work;
+        m_RealFFT->Forward(input, inputSize, spectrum, work + half + 1);
+        for (SizeValueType bin = 0; bin < m_NumberOfBins; ++bin)
+        {
+          const SizeValueType k = m_FirstBin + bin;
+          output[bin] = (k <= half) ? spectrum[k] : std::conj(spectrum[m_Size - k]);
+        }
+        break;
+      }
+      case PRUNED_FFT:
+        this->PrunedForward(input, inputSize, output, work);
+        break;
+      default:
+        this->GoertzelForward(input, inputSize, output);
+        break;
+    }
+  }
+
+private:
+  void
+  GoertzelForward(const RealType * input, SizeValueType inputSize, ComplexType * output) const
+  {
+    // s[j] = x[j] + 2 cos(theta) s[j - 1] - s[j - 2], and the bin is
+    // w^{M - 1} (s[M - 1] - w s[M - 2]) with w = e^{-i theta} and M = inputSize;
+    // the recursion runs in double precision to limit the error growth
+    for (SizeValueType bin = 0; bin < m_NumberOfBins; ++bin)
+    {
+      const SizeValueType k = m_FirstBin + bin;
+      const double        theta = 2.0 * Math::pi * static_cast<double>(k) / static_cast<double>(m_Size);
+      const double        coefficient = 2.0 * std::cos(theta);
+      double              s1 = 0.0;
+      double              s2 = 0.0;
+      for (SizeValueType j = 0; j < inputSize; ++j)
+      {
+        const double s0 = static_cast<double>(input[j]) + coefficient * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+      }
+      if (inputSize == 0)
+      {
+        output[bin] = ComplexType(0);
+        continue;
+      }
+      const SizeValueType phase = (k * (inputSize - 1)) % m_Size;
+      const double        phaseAngle = -2.0 * Math::pi * static_cast<double>(phase) / static_cast<double>(m_Size);
+      const std::complex<double> value =
+        std::polar(1.0, phaseAngle) * (std::complex<double>(s1) - std::polar(1.0, -theta) * s2);
+      output[bin] = ComplexType(static_cast<RealType>(value.real()), static_cast<RealType>(value.imag()));
+    }
+  }
+
+  void
+  PrunedForward(const RealType * input, SizeValueType inputSize, ComplexType * output, ComplexType * work) const
+  {
+    const SizeValueType subLines = m_NumberOfSubLines;
+    const SizeValueType subLineSize = m_SubLineFFT->GetSize();
+    ComplexType *       subSpectra = work;
+    ComplexType *       packed = work + m_Size;
+    ComplexType *       z = packed + subLineSize;
+    ComplexType *       subLineWork = z + subLineSize;
+    const auto          validSize = [inputSize, subLines](SizeValueType p) -> SizeValueType {
+      // the decimated sub-lines are zero padded too
+      return (inputSize > p) ? (inputSize - p + subLines - 1) / subLines : 0;
+    };
+    for (SizeValueType p = 0; p < subLines; p += 2)
+    {
+      // the sub-lines p and p + 1 are packed as real and imaginary parts, and
+      // Y_p[k] = (Z[k] + conj(Z[L - k])) / 2,
+      // Y_{p + 1}[k] = -i (Z[k] - conj(Z[L - k])) / 2
+      const SizeValueType packedSize = validSize(p);
+      const SizeValueType oddSize = (p + 1 < subLines) ? validSize(p + 1) : 0;
+      for (SizeValueType l = 0; l < packedSize; ++l)
+      {
+        packed[l] = ComplexType(input[p + subLines * l], (l < oddSize) ? input[p + 1 + subLines * l] : RealType(0));
+      }
+      m_SubLineFFT->Forward(packed, packedSize, z, subLineWork);
+      ComplexType * even = subSpectra + p * subLineSize;
+      if (p + 1 == subLines)
+      {
+        std::copy(z, z + subLineSize, even);
+        continue;
+      }
+      ComplexType * odd = even + subLineSize;
+      for (SizeValueType k = 0; k < subLineSize; ++k)
+      {
+        const ComplexType zk = z[k];
+        const ComplexType zc = std::conj(z[(subLineSize - k) % subLineSize]);
+        even[k] = (zk + zc) * RealType(0.5);
+        odd[k] = (zk - zc) * ComplexType(0, RealType(-0.5));
+      }
+    }
+    for (SizeValueType bin = 0; bin < m_NumberOfBins; ++bin)
+    {
+      const SizeValueType k = m_FirstBin + bin;
+      const ComplexType * subSpectrum = subSpectra + k % subLineSize;
+      ComplexType         sum = subSpectrum[0];
+      SizeValueType       twiddle = 0;
+      for (SizeValueType p = 1; p < subLines; ++p)
+      {
+        // w^{pk}, with the exponent kept modulo the size
+        twiddle += k;
+        if (twiddle >= m_Size)
+        {
+          twiddle -= m_Size;
+        }
+        sum += m_Twiddles[twiddle] * subSpectrum[p * subLineSize];
+      }
+      output[bin] = sum;
+    }
+  }
+
+  SizeValueType                            m_Size;
+  SizeValueType                            m_FirstBin;
+  SizeValueType                            m_NumberOfBins;
+  AlgorithmType                            m_Algorithm;
+  SizeValueType                            m_NumberOfSubLines;
+  std::unique_ptr<NativeRealFFT<RealType>> m_RealFFT;
+  std::unique_ptr<NativeFFT<RealType>>     m_SubLineFFT;
+  std::vector<ComplexType>                 m_Twiddles;
+};
+
+} // end namespace fft1d
+} // end namespace itk
+
+#endif // itkNativeFFT1D_h
@@ -0,0 +1,573 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkNativeFFTSIMD_h
+#define itkNativeFFTSIMD_h
+
+/* Instruction set used by the native FFT kernels. It is chosen at compile
+ * time with one of
+ *
+ *   ITKUltrasound_NATIVE_FFT_ISA_AVX512
+ *   ITKUltrasound_NATIVE_FFT_ISA_AVX2
+ *   ITKUltrasound_NATIVE_FFT_ISA_NEON
+ *   ITKUltrasound_NATIVE_FFT_ISA_SCALAR
+ *
+ * as set on the targets of the module by the ITKUltrasound_NATIVE_FFT_ISA
+ * CMake option; by default, and in the code using the module, the widest
+ * instruction set the compiler targets is used. */
+#if defined(ITKUltrasound_NATIVE_FFT_ISA_AVX512)
+#  if !defined(__AVX512F__)
+#    error "The AVX-512 native FFT kernels require a compiler targeting AVX-512F"
+#  endif
+#  define ITKUltrasound_NATIVE_FFT_AVX512
+#elif defined(ITKUltrasound_NATIVE_FFT_ISA_AVX2)
+#  if !defined(__AVX2__)
+#    error "The AVX2 native FFT kernels require a compiler targeting AVX2"
+#  endif
+#  define ITKUltrasound_NATIVE_FFT_AVX2
+#elif defined(ITKUltrasound_NATIVE_FFT_ISA_NEON)
+#  if !defined(__ARM_NEON)
+#    error "The NEON native FFT kernels require a compiler targeting NEON"
+#  endif
+#  define ITKUltrasound_NATIVE_FFT_NEON
+#elif !defined(ITKUltrasound_NATIVE_FFT_ISA_SCALAR)
+#  if defined(__AVX512F__)
+#    define ITKUltrasound_NATIVE_FFT_AVX512
+#  elif defined(__AVX2__)
+#    define ITKUltrasound_NATIVE_FFT_AVX2
+#  elif defined(__ARM_NEON)
+#    define ITKUltrasound_NATIVE_FFT_NEON
+#  endif
+#endif
+
+#if defined(ITKUltrasound_NATIVE_FFT_AVX512) || defined(ITKUltrasound_NATIVE_FFT_AVX2)
+#  include <immintrin.h>
+#elif defined(ITKUltrasound_NATIVE_FFT_NEON)
+#  include <arm_neon.h>
+#endif
+
+namespace itk
+{
+namespace fft1d
+{
+
+/** \class ScalarComplexPack
+ * \brief A single complex value with the interface of the SIMD complex packs.
+ *
+ * A complex pack holds Width consecutive complex values stored as
+ * interleaved real and imaginary parts, as in std::complex arrays. The native
+ * FFT kernels are written once against this interface and instantiated with
+ * the widest pack available for the instruction set.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TReal>
+struct ScalarComplexPack
+{
+  using RealType = TReal;
+  static constexpr unsigned int Width = 1;
+
+  RealType m_Real;
+  RealType m_Imaginary;
+
+  static ScalarComplexPack
+  Load(const RealType * p)
+  {
+    return { p[0], p[1] };
+  }
+  void
+  Store(RealType * p) const
+  {
+    p[0] = m_Real;
+    p[1] = m_Imaginary;
+  }
+  ScalarComplexPack
+  operator+(const ScalarComplexPack & other) const
+  {
+    return { m_Real + other.m_Real, m_Imaginary + other.m_Imaginary };
+  }
+  ScalarComplexPack
+  operator-(const ScalarComplexPack & other) const
+  {
+    return { m_Real - other.m_Real, m_Imaginary - other.m_Imaginary };
+  }
+  /** Multiply by the real number a. */
+  ScalarComplexPack
+  Scale(RealType a) const
+  {
+    return { m_Real * a, m_Imaginary * a };
+  }
+  /** Multiply by the complex number c + i d. */
+  ScalarComplexPack
+  Multiply(RealType c, RealType d) const
+  {
+    return { m_Real * c - m_Imaginary * d, m_Real * d + m_Imaginary * c };
+  }
+  /** Multiply element-wise by the complex values of other. */
+  ScalarComplexPack
+  Multiply(const ScalarComplexPack & other) const
+  {
+    return this->Multiply(other.m_Real, other.m_Imaginary);
+  }
+  /** Multiply by i. */
+  ScalarComplexPack
+  MultiplyByI() const
+  {
+    return { -m_Imaginary, m_Real };
+  }
+  /** Multiply by -i. */
+  ScalarComplexPack
+  MultiplyByMinusI() const
+  {
+    return { m_Imaginary, -m_Real };
+  }
+};
+
+
+/** \class VectorComplexPack
+ * \brief Complex pack holding as many complex values as a SIMD register of
+ * the selected instruction set.
+ *
+ * Only the specializations for the instruction set in use are defined.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TReal>
+struct VectorComplexPack;
+
+
+#if defined(ITKUltrasound_NATIVE_FFT_AVX512)
+
+template <>
+struct VectorComplexPack<double>
+{
+  using RealType = double;
+  static constexpr unsigned int Width = 4;
+
+  __m512d m_Value;
+
+  static VectorComplexPack
+  Load(const RealType * p)
+  {
+    return { _mm512_loadu_pd(p) };
+  }
+  void
+  Store(RealType * p) const
+  {
+    _mm512_storeu_pd(p, m_Value);
+  }
+  VectorComplexPack
+  operator+(const VectorComplexPack & other) const
+  {
+    return { _mm512_add_pd(m_Value, other.m_Value) };
+  }
+  VectorComplexPack
+  operator-(const VectorComplexPack & other) const
+  {
+    return { _mm512_sub_pd(m_Value, other.m_Value) };
+  }
+  VectorComplexPack
+  Scale(RealType a) const
+  {
+    return { _mm512_mul_pd(m_Value, _mm512_set1_pd(a)) };
+  }
+  VectorComplexPack
+  Multiply(RealType c, RealType d) const
+  {
+    // (re c - im d, im c + re d) from the real and imaginary parts swapped
+    const __m512d swapped = _mm512_permute_pd(m_Value, 0x55);
+    return { _mm512_fmaddsub_pd(m_Value, _mm512_set1_pd(c), _mm512_mul_pd(swapped, _mm512_set1_pd(d))) };
+  }
+  VectorComplexPack
+  Multiply(const VectorComplexPack & other) const
+  {
+    const __m512d swapped = _mm512_permute_pd(m_Value, 0x55);
+    const __m512d real = _mm512_movedup_pd(other.m_Value);
+    const __m512d imaginary = _mm512_permute_pd(other.m_Value, 0xFF);
+    return { _mm512_fmaddsub_pd(m_Value, real, _mm512_mul_pd(swapped, imaginary)) };
+  }
+  VectorComplexPack
+  MultiplyByI() const
+  {
+    const __m512d swapped = _mm512_permute_pd(m_Value, 0x55);
+    return { _mm512_mul_pd(swapped, _mm512_set_pd(1.0, -1.0, 1.0, -1.0, 1.0, -1.0, 1.0, -1.0)) };
+  }
+  VectorComplexPack
+  MultiplyByMinusI() const
+  {
+    const __m512d swapped = _mm512_permute_pd(m_Value, 0x55);
+    return { _mm512_mul_pd(swapped, _mm512_set_pd(-1.0, 1.0, -1.0, 1.0, -1.0, 1.0, -1.0, 1.0)) };
+  }
+};
+
+template <>
+struct VectorComplexPack<float>
+{
+  using RealType = float;
+  static constexpr unsigned int Width = 8;
+
+  __m512 m_Value;
+
+  static VectorComplexPack
+  Load(const RealType * p)
+  {
+    return { _mm512_loadu_ps(p) };
+  }
+  void
+  Store(RealType * p) const
+  {
+    _mm512_storeu_ps(p, m_Value);
+  }
+  VectorComplexPack
+  operator+(const VectorComplexPack & other) const
+  {
+    return { _mm512_add_ps(m_Value, other.m_Value) };
+  }
+  VectorComplexPack
+  operator-(const VectorComplexPack & other) const
+  {
+    return { _mm512_sub_ps(m_Value, other.m_Value) };
+  }
+  VectorComplexPack
+  Scale(RealType a) const
+  {
+    return { _mm512_mul_ps(m_Value, _mm512_set1_ps(a)) };
+  }
+  VectorComplexPack
+  Multiply(RealType c, RealType d) const
+  {
+    const __m512 swapped = _mm512_permute_ps(m_Value, 0xB1);
+    return { _mm512_fmaddsub_ps(m_Value, _mm512_set1_ps(c), _mm512_mul_ps(swapped, _mm512_set1_ps(d))) };
+  }
+  VectorComplexPack
+  Multiply(const VectorComplexPack & other) const
+  {
+    const __m512 swapped = _mm512_permute_ps(m_Value, 0xB1);
+    const __m512 real = _mm512_moveldup_ps(other.m_Value);
+    const __m512 imaginary = _mm512_movehdup_ps(other.m_Value);
+    return { _mm512_fmaddsub_ps(m_Value, real, _mm512_mul_ps(swapped, imaginary)) };
+  }
+  VectorComplexPack
+  MultiplyByI() const
+  {
+    const __m512 swapped = _mm512_permute_ps(m_Value, 0xB1);
+    return { _mm512_mul_ps(swapped,
+                           _mm512_set_ps(1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f,
+                                         1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f)) };
+  }
+  VectorComplexPack
+  MultiplyByMinusI() const
+  {
+    const __m512 swapped = _mm512_permute_ps(m_Value, 0xB1);
+    return { _mm512_mul_ps(swapped,
+                           _mm512_set_ps(-1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f,
+                                         -1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f)) };
+  }
+};
+
+#elif defined(ITKUltrasound_NATIVE_FFT_AVX2)
+
+template <>
+struct VectorComplexPack<double>
+{
+  using RealType = double;
+  static constexpr unsigned int Width = 2;
+
+  __m256d m_Value;
+
+  static VectorComplexPack
+  Load(const RealType * p)
+  {
+    return { _mm256_loadu_pd(p) };
+  }
+  void
+  Store(RealType * p) const
+  {
+    _mm256_storeu_pd(p, m_Value);
+  }
+  VectorComplexPack
+  operator+(const VectorComplexPack & other) const
+  {
+    return { _mm256_add_pd(m_Value, other.m_Value) };
+  }
+  VectorComplexPack
+  operator-(const VectorComplexPack & other) const
+  {
+    return { _mm256_sub_pd(m_Value, other.m_Value) };
+  }
+  VectorComplexPack
+  Scale(RealType a) const
+  {
+    return { _mm256_mul_pd(m_Value, _mm256_set1_pd(a)) };
+  }
+  VectorComplexPack
+  Multiply(RealType c, RealType d) const
+  {
+    // (re c - im d, im c + re d) from the real and imaginary parts swapped
+    const __m256d swapped = _mm256_permute_pd(m_Value, 0x5);
+    return { _mm256_addsub_pd(_mm256_mul_pd(m_Value, _mm256_set1_pd(c)), _mm256_mul_pd(swapped, _mm256_set1_pd(d))) };
+  }
+  VectorComplexPack
+  Multiply(const VectorComplexPack & other) const
+  {
+    const __m256d swapped = _mm256_permute_pd(m_Value, 0x5);
+    const __m256d real = _mm256_movedup_pd(other.m_Value);
+    const __m256d imaginary = _mm256_permute_pd(other.m_Value, 0xF);
+    return { _mm256_addsub_pd(_mm256_mul_pd(m_Value, real), _mm256_mul_pd(swapped, imaginary)) };
+  }
+  VectorComplexPack
+  MultiplyByI() const
+  {
+    const __m256d swapped = _mm256_permute_pd(m_Value, 0x5);
+    return { _mm256_mul_pd(swapped, _mm256_set_pd(1.0, -1.0, 1.0, -1.0)) };
+  }
+  VectorComplexPack
+  MultiplyByMinusI() const
+  {
+    const __m256d swapped = _mm256_permute_pd(m_Value, 0x5);
+    return { _mm256_mul_pd(swapped, _mm256_set_pd(-1.0, 1.0, -1.0, 1.0)) };
+  }
+};
+
+template <>
+struct VectorComplexPack<float>
+{
+  using RealType = float;
+  static constexpr unsigned int Width = 4;
+
+  __m256 m_Value;
+
+  static VectorComplexPack
+  Load(const RealType * p)
+  {
+    return { _mm256_loadu_ps(p) };
+  }
+  void
+  Store(RealType * p) const
+  {
+    _mm256_storeu_ps(p, m_Value);
+  }
+  VectorComplexPack
+  operator+(const VectorComplexPack & other) const
+  {
+    return { _mm256_add_ps(m_Value, other.m_Value) };
+  }
+  VectorComplexPack
+  operator-(const VectorComplexPack & other) const
+  {
+    return { _mm256_sub_ps(m_Value, other.m_Value) };
+  }
+  VectorComplexPack
+  Scale(RealType a) const
+  {
+    return { _mm256_mul_ps(m_Value, _mm256_set1_ps(a)) };
+  }
+  VectorComplexPack
+  Multiply(RealType c, RealType d) const
+  {
+    const __m256 swapped = _mm256_permute_ps(m_Value, 0xB1);
+    return { _mm256_addsub_ps(_mm256_mul_ps(m_Value, _mm256_set1_ps(c)), _mm256_mul_ps(swapped, _mm256_set1_ps(d))) };
+  }
+  VectorComplexPack
+  Multiply(const VectorComplexPack & other) const
+  {
+    const __m256 swapped = _mm256_permute_ps(m_Value, 0xB1);
+    const __m256 real = _mm256_moveldup_ps(other.m_Value);
+    const __m256 imaginary = _mm256_movehdup_ps(other.m_Value);
+    return { _mm256_addsub_ps(_mm256_mul_ps(m_Value, real), _mm256_mul_ps(swapped, imaginary)) };
+  }
+  VectorComplexPack
+  MultiplyByI() const
+  {
+    const __m256 swapped = _mm256_permute_ps(m_Value, 0xB1);
+    return { _mm256_mul_ps(swapped, _mm256_set_ps(1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f)) };
+  }
+  VectorComplexPack
+  MultiplyByMinusI() const
+  {
+    const __m256 swapped = _mm256_permute_ps(m_Value, 0xB1);
+    return { _mm256_mul_ps(swapped, _mm256_set_ps(-1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f)) };
+  }
+};
+
+#elif defined(ITKUltrasound_NATIVE_FFT_NEON)
+
+template <>
+struct VectorComplexPack<float>
+{
+  using RealType = float;
+  static constexpr unsigned int Width = 2;
+
+  float32x4_t m_Value;
+
+  static VectorComplexPack
+  Load(const RealType * p)
+  {
+    return { vld1q_f32(p) };
+  }
+  void
+  Store(RealType * p) const
+  {
+    vst1q_f32(p, m_Value);
+  }
+  VectorComplexPack
+  operator+(const VectorComplexPack & other) const
+  {
+    return { vaddq_f32(m_Value, other.m_Value) };
+  }
+  VectorComplexPack
+  operator-(const VectorComplexPack & other) const
+  {
+    return { vsubq_f32(m_Value, other.m_Value) };
+  }
+  VectorComplexPack
+  Scale(RealType a) const
+  {
+    return { vmulq_n_f32(m_Value, a) };
+  }
+  VectorComplexPack
+  Multiply(RealType c, RealType d) const
+  {
+    // (re c - im d, im c + re d) from the real and imaginary parts swapped
+    const float32x4_t swapped = vrev64q_f32(m_Value);
+    const float       signs[4] = { -1.f, 1.f, -1.f, 1.f };
+    return { vmlaq_f32(vmulq_n_f32(m_Value, c), vmulq_n_f32(swapped, d), vld1q_f32(signs)) };
+  }
+  VectorComplexPack
+  Multiply(const VectorComplexPack & other) const
+  {
+    const float32x4_t   swapped = vrev64q_f32(m_Value);
+    const float32x4x2_t parts = vtrnq_f32(other.m_Value, other.m_Value);
+    const float         signs[4] = { -1.f, 1.f, -1.f, 1.f };
+    return { vmlaq_f32(vmulq_f32(m_Value, parts.val[0]), vmulq_f32(swapped, parts.val[1]), vld1q_f32(signs)) };
+  }
+  VectorComplexPack
+  MultiplyByI() const
+  {
+    const float signs[4] = { -1.f, 1.f, -1.f, 1.f };
+    return { vmulq_f32(vrev64q_f32(m_Value), vld1q_f32(signs)) };
+  }
+  VectorComplexPack
+  MultiplyByMinusI() const
+  {
+    const float signs[4] = { 1.f, -1.f, 1.f, -1.f };
+    return { vmulq_f32(vrev64q_f32(m_Value), vld1q_f32(signs)) };
+  }
+};
+
+#  if defined(__aarch64__)
+template <>
+struct VectorComplexPack<double>
+{
+  using RealType = double;
+  static constexpr unsigned int Width = 1;
+
+  float64x2_t m_Value;
+
+  static VectorComplexPack
+  Load(const RealType * p)
+  {
+    return { vld1q_f64(p) };
+  }
+  void
+  Store(RealType * p) const
+  {
+    vst1q_f64(p, m_Value);
+  }
+  VectorComplexPack
+  operator+(const VectorComplexPack & other) const
+  {
+    return { vaddq_f64(m_Value, other.m_Value) };
+  }
+  VectorComplexPack
+  operator-(const VectorComplexPack & other) const
+  {
+    return { vsubq_f64(m_Value, other.m_Value) };
+  }
+  VectorComplexPack
+  Scale(RealType a) const
+  {
+    return { vmulq_n_f64(m_Value, a) };
+  }
+  VectorComplexPack
+  Multiply(RealType c, RealType d) const
+  {
+    const float64x2_t swapped = vextq_f64(m_Value, m_Value, 1);
+    const double      signs[2] = { -1.0, 1.0 };
+    return { vfmaq_f64(vmulq_n_f64(m_Value, c), vmulq_n_f64(swapped, d), vld1q_f64(signs)) };
+  }
+  VectorComplexPack
+  Multiply(const VectorComplexPack & other) const
+  {
+    const float64x2_t swapped = vextq_f64(m_Value, m_Value, 1);
+    const float64x2_t real = vdupq_laneq_f64(other.m_Value, 0);
+    const float64x2_t imaginary = vdupq_laneq_f64(other.m_Value, 1);
+    const double      signs[2] = { -1.0, 1.0 };
+    return { vfmaq_f64(vmulq_f64(m_Value, real), vmulq_f64(swapped, imaginary), vld1q_f64(signs)) };
+  }
+  VectorComplexPack
+  MultiplyByI() const
+  {
+    const double signs[2] = { -1.0, 1.0 };
+    return { vmulq_f64(vextq_f64(m_Value, m_Value, 1), vld1q_f64(signs)) };
+  }
+  VectorComplexPack
+  MultiplyByMinusI() const
+  {
+    const double signs[2] = { 1.0, -1.0 };
+    return { vmulq_f64(vextq_f64(m_Value, m_Value, 1), vld1q_f64(signs)) };
+  }
+};
+#  endif
+
+#endif
+
+
+/** \class WidestComplexPack
+ * \brief Widest complex pack available for TReal with the selected
+ * instruction set, a ScalarComplexPack when there is none.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TReal>
+struct WidestComplexPack
+{
+  using Type = ScalarComplexPack<TReal>;
+};
+
+#if defined(ITKUltrasound_NATIVE_FFT_AVX512) || defined(ITKUltrasound_NATIVE_FFT_AVX2) || \
+  defined(ITKUltrasound_NATIVE_FFT_NEON)
+template <>
+struct WidestComplexPack<float>
+{
+  using Type = VectorComplexPack<float>;
+};
+#endif
+
+#if defined(ITKUltrasound_NATIVE_FFT_AVX512) || defined(ITKUltrasound_NATIVE_FFT_AVX2) || \
+  (defined(ITKUltrasound_NATIVE_FFT_NEON) && defined(__aarch64__))
+template <>
+struct WidestComplexPack<double>
+{
+  using Type = VectorComplexPack<double>;
+};
+#endif
+
+} // end namespace fft1d
+} // end namespace itk
+
+#endif // itkNativeFFTSIMD_h
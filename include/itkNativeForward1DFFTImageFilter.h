@@ -0,0 +1,93 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkNativeForward1DFFTImageFilter_h
+#define itkNativeForward1DFFTImageFilter_h
+
+#include "itkForward1DFFTImageFilter.h"
+#include "itkNativeFFT1D.h"
+#include <complex>
+
+namespace itk
+{
+
+/** \class NativeForward1DFFTImageFilter
+ *
+ * \brief Perform the FFT along one dimension of an image using the built-in
+ * SIMD kernels of fft1d::NativeFFT as a backend.
+ *
+ * This is the default backend when FFTW is not available. Any line size is
+ * supported, sizes with prime factors greater than GetSizeGreatestPrimeFactor()
+ * at a few times the cost through Bluestein's algorithm. The lines are
+ * transformed with a complex FFT of half their size when their size is even.
+ * When a band of bins is requested, only the band is computed, see
+ * fft1d::NativeRealFFTBand.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TInputImage,
+          typename TOutputImage =
+            Image<std::complex<typename fft1d::RealFFTPrecision<typename TInputImage::PixelType>::Type>,
+                  TInputImage::ImageDimension>>
+class ITK_TEMPLATE_EXPORT NativeForward1DFFTImageFilter : public Forward1DFFTImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(NativeForward1DFFTImageFilter);
+
+  /** Standard class type alias. */
+  using Self = NativeForward1DFFTImageFilter;
+  using Superclass = Forward1DFFTImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using InputImageType = typename Superclass::InputImageType;
+  using OutputImageType = typename Superclass::OutputImageType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  using RealType = typename NumericTraits<typename OutputImageType::PixelType>::ValueType;
+  using FFTType = fft1d::NativeRealFFT<RealType>;
+  using BandFFTType = fft1d::NativeRealFFTBand<RealType>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(NativeForward1DFFTImageFilter, Forward1DFFTImageFilter);
+
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const override
+  {
+    return fft1d::NativeFFT<RealType>::GreatestPrimeFactor;
+  }
+
+protected:
+  void
+  GenerateData() override;
+
+  NativeForward1DFFTImageFilter() {}
+  virtual ~NativeForward1DFFTImageFilter() {}
+
+private:
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkNativeForward1DFFTImageFilter.hxx"
+#endif
+
+#endif
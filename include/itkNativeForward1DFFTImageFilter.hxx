@@ -0,0 +1,122 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkNativeForward1DFFTImageFilter_hxx
+#define itkNativeForward1DFFTImageFilter_hxx
+
+#include "itkNativeForward1DFFTImageFilter.h"
+
+#include "itkFFT1DLineBatch.h"
+#include "itkFFT1DScratchArena.h"
+#include "itkForward1DFFTImageFilter.hxx"
+#include "itkIndent.h"
+#include "itkMetaDataObject.h"
+#include "itkMacro.h"
+
+#include <memory>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+void
+NativeForward1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+
+  // get pointers to the input and output
+  const typename Superclass::InputImageType * input = this->GetInput();
+  typename Superclass::OutputImageType *      output = this->GetOutput();
+
+  const typename Superclass::InputImageType::SizeType & inputSize = input->GetRequestedRegion().GetSize();
+
+  const unsigned int  direction = this->GetDirection();
+  const SizeValueType inputLineSize = inputSize[direction];
+  // the input lines are zero padded up to the transform size, without
+  // copying the zeros: the transform skips them
+  const SizeValueType vectorSize = this->GetTransformLineSize();
+
+  // shared by the work units, see fft1d::ForEachLineTile; only the requested
+  // band is computed when there is one
+  std::unique_ptr<const FFTType>     fft;
+  std::unique_ptr<const BandFFTType> bandFFT;
+  if (this->GetNumberOfFrequencyBins() > 0)
+  {
+    bandFFT.reset(new BandFFTType(vectorSize, this->GetFirstFrequencyBin(), this->GetNumberOfFrequencyBins()));
+  }
+  else
+  {
+    fft.reset(new FFTType(vectorSize));
+  }
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegionRestrictDirection<TOutputImage::ImageDimension>(
+    direction,
+    output->GetRequestedRegion(),
+    [input, output, direction, inputLineSize, vectorSize, &fft, &bandFFT](
+      const typename OutputImageType::RegionType & lambdaRegion) {
+      using ComplexType = typename FFTType::ComplexType;
+      // the output lines are shorter than the input ones in HalfSpectrum mode
+      // or with a band
+      const SizeValueType  outputLineSize = lambdaRegion.GetSize(direction);
+      const IndexValueType inputLineStart = input->GetRequestedRegion().GetIndex(direction);
+
+      // buffers of a tile of lines, see fft1d::ForEachLineTile
+      fft1d::ScratchBuffer<RealType>    inputBuffer(fft1d::MaximumLineTileSize * inputLineSize);
+      fft1d::ScratchBuffer<ComplexType> outputBuffer(fft1d::MaximumLineTileSize * outputLineSize);
+      fft1d::ScratchBuffer<ComplexType> workBuffer(bandFFT ? bandFFT->GetWorkSize() : fft->GetWorkSize());
+
+      fft1d::ForEachLineTile(
+        lambdaRegion,
+        direction,
+        fft1d::MaximumLineTileSize,
+        [&](const typename OutputImageType::IndexType & tileStart, SizeValueType numberOfLines) {
+          typename InputImageType::IndexType inputTileStart = tileStart;
+          inputTileStart[direction] = inputLineStart;
+          fft1d::GatherLineTile(input, inputTileStart, direction, inputLineSize, numberOfLines, inputBuffer.data());
+
+          for (SizeValueType line = 0; line < numberOfLines; ++line)
+          {
+            ComplexType *    spectrum = outputBuffer.data() + line * outputLineSize;
+            const RealType * lineBuffer = inputBuffer.data() + line * inputLineSize;
+            if (bandFFT)
+            {
+              bandFFT->Forward(lineBuffer, inputLineSize, spectrum, workBuffer.data());
+              continue;
+            }
+
+            // do the transform, which only computes the non-negative frequencies
+            fft->Forward(lineBuffer, inputLineSize, spectrum, workBuffer.data());
+
+            // complete the negative frequencies from the Hermitian symmetry
+            // when needed
+            for (SizeValueType k = vectorSize / 2 + 1; k < outputLineSize; ++k)
+            {
+              spectrum[k] = std::conj(spectrum[vectorSize - k]);
+            }
+          }
+
+          fft1d::ScatterLineTile(output, tileStart, direction, outputLineSize, numberOfLines, outputBuffer.data());
+        });
+    },
+    this);
+}
+
+} // end namespace itk
+
+#endif
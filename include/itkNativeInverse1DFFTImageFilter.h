@@ -0,0 +1,91 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkNativeInverse1DFFTImageFilter_h
+#define itkNativeInverse1DFFTImageFilter_h
+
+#include "itkInverse1DFFTImageFilter.h"
+#include "itkNativeFFT1D.h"
+#include <complex>
+
+namespace itk
+{
+
+/** \class NativeInverse1DFFTImageFilter
+ *
+ * \brief Perform the inverse FFT along one dimension of an image using the
+ * built-in SIMD kernels of fft1d::NativeFFT as a backend.
+ *
+ * This is the default backend when FFTW is not available. Any line size is
+ * supported, sizes with prime factors greater than GetSizeGreatestPrimeFactor()
+ * at a few times the cost through Bluestein's algorithm. In HalfSpectrum mode
+ * the lines are transformed with a complex FFT of half their size when their
+ * size is even.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TInputImage,
+          typename TOutputImage =
+            Image<typename NumericTraits<typename TInputImage::PixelType>::ValueType, TInputImage::ImageDimension>>
+class ITK_TEMPLATE_EXPORT NativeInverse1DFFTImageFilter : public Inverse1DFFTImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(NativeInverse1DFFTImageFilter);
+
+  /** Standard class type alias. */
+  using Self = NativeInverse1DFFTImageFilter;
+  using Superclass = Inverse1DFFTImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using InputImageType = typename Superclass::InputImageType;
+  using OutputImageType = typename Superclass::OutputImageType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  using RealType = typename OutputImageType::PixelType;
+  using FFTType = fft1d::NativeFFT<RealType>;
+  using RealFFTType = fft1d::NativeRealFFT<RealType>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(NativeInverse1DFFTImageFilter, Inverse1DFFTImageFilter);
+
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const override
+  {
+    return FFTType::GreatestPrimeFactor;
+  }
+
+protected:
+  void
+  GenerateData() override;
+
+  NativeInverse1DFFTImageFilter() {}
+  virtual ~NativeInverse1DFFTImageFilter() {}
+
+private:
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkNativeInverse1DFFTImageFilter.hxx"
+#endif
+
+#endif
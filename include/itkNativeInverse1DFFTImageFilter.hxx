@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkNativeInverse1DFFTImageFilter_hxx
+#define itkNativeInverse1DFFTImageFilter_hxx
+
+#include "itkNativeInverse1DFFTImageFilter.h"
+
+#include "itkFFT1DLineBatch.h"
+#include "itkFFT1DScratchArena.h"
+#include "itkInverse1DFFTImageFilter.hxx"
+#include "itkIndent.h"
+#include "itkMetaDataObject.h"
+#include "itkMacro.h"
+
+#include <memory>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+void
+NativeInverse1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+
+  // get pointers to the input and output
+  const typename Superclass::InputImageType * input = this->GetInput();
+  typename Superclass::OutputImageType *      output = this->GetOutput();
+
+  const typename Superclass::OutputImageType::SizeType & outputSize = output->GetRequestedRegion().GetSize();
+
+  const unsigned int  direction = this->GetDirection();
+  const SizeValueType vectorSize = outputSize[direction];
+
+  // shared by the work units, see fft1d::ForEachLineTile; the real transform
+  // only reads the non-negative frequencies, which is enough when the
+  // spectrum is Hermitian
+  const bool                         halfSpectrum = this->m_HalfSpectrum || this->m_HermitianInput;
+  std::unique_ptr<const FFTType>     fft;
+  std::unique_ptr<const RealFFTType> realFFT;
+  if (halfSpectrum)
+  {
+    realFFT.reset(new RealFFTType(vectorSize));
+  }
+  else
+  {
+    fft.reset(new FFTType(vectorSize));
+  }
+
+  // the 1/N normalization is skipped in unnormalized mode
+  const RealType scale = this->m_Normalize ? RealType(1) / static_cast<RealType>(vectorSize) : RealType(1);
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegionRestrictDirection<TOutputImage::ImageDimension>(
+    direction,
+    output->GetRequestedRegion(),
+    [input, output, direction, vectorSize, halfSpectrum, scale, &fft, &realFFT](
+      const typename OutputImageType::RegionType & lambdaRegion) {
+      using ComplexType = typename FFTType::ComplexType;
+      // the input lines only hold the non-negative frequencies in HalfSpectrum
+      // mode, and only those are read from Hermitian input lines
+      const SizeValueType  inputLineSize =
+        halfSpectrum ? vectorSize / 2 + 1 : input->GetRequestedRegion().GetSize(direction);
+      const IndexValueType inputLineStart = input->GetRequestedRegion().GetIndex(direction);
+
+      // buffers of a tile of lines, see fft1d::ForEachLineTile
+      fft1d::ScratchBuffer<ComplexType> inputBuffer(fft1d::MaximumLineTileSize * inputLineSize);
+      fft1d::ScratchBuffer<ComplexType> outputBuffer(halfSpectrum ? 0 : vectorSize);
+      fft1d::ScratchBuffer<RealType>    realOutputBuffer(fft1d::MaximumLineTileSize * vectorSize);
+      fft1d::ScratchBuffer<ComplexType> workBuffer(halfSpectrum ? realFFT->GetWorkSize() : fft->GetWorkSize());
+
+      fft1d::ForEachLineTile(
+        lambdaRegion,
+        direction,
+        fft1d::MaximumLineTileSize,
+        [&](const typename OutputImageType::IndexType & tileStart, SizeValueType numberOfLines) {
+          typename InputImageType::IndexType inputTileStart = tileStart;
+          inputTileStart[direction] = inputLineStart;
+          fft1d::GatherLineTile(input, inputTileStart, direction, inputLineSize, numberOfLines, inputBuffer.data());
+
+          for (SizeValueType line = 0; line < numberOfLines; ++line)
+          {
+            const ComplexType * inputLine = inputBuffer.data() + line * inputLineSize;
+            RealType *          outputLine = realOutputBuffer.data() + line * vectorSize;
+
+            // do the transform
+            if (halfSpectrum)
+            {
+              realFFT->Backward(inputLine, outputLine, workBuffer.data());
+              if (scale != RealType(1))
+              {
+                for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+                {
+                  outputLine[ii] *= scale;
+                }
+              }
+            }
+            else
+            {
+              fft->Backward(inputLine, outputBuffer.data(), workBuffer.data());
+              for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+              {
+                outputLine[ii] = outputBuffer[ii].real() * scale;
+              }
+            }
+          }
+
+          fft1d::ScatterLineTile(output, tileStart, direction, vectorSize, numberOfLines, realOutputBuffer.data());
+        });
+    },
+    this);
+}
+
+} // end namespace itk
+
+#endif
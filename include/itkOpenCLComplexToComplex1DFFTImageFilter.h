@@ -20,10 +20,15 @@
 
 #  include "itkComplexToComplex1DFFTImageFilter.h"
 
+#  include "itkOpenCLFFT1DLinePipeline.h"
+#  include "itkclFFTContextManager.h"
+
 #  define __CL_ENABLE_EXCEPTIONS
 #  include "CL/cl.hpp"
 #  include "clFFT.h"
 
+#  include <vector>
+
 namespace itk
 {
 /** \class OpenCLComplexToComplex1DFFTImageFilter
@@ -72,19 +77,16 @@ public:
     return 7; // clFFT supports prime factors 2, 3, 5 and 7
   }
 
+  /** Set/Get the number of lines transformed by the device at a time. The
+   * transfers of a chunk overlap the transform of the previous one, and the
+   * host gathers and scatters the lines of a chunk in parallel. The default, 0,
+   * transforms the lines in four chunks. */
+  itkSetMacro(NumberOfLinesPerChunk, SizeValueType);
+  itkGetConstMacro(NumberOfLinesPerChunk, SizeValueType);
+
 protected:
   OpenCLComplexToComplex1DFFTImageFilter();
-  virtual ~OpenCLComplexToComplex1DFFTImageFilter()
-  {
-    if (m_PlanComputed)
-    {
-      clfftDestroyPlan(&this->m_Plan);
-      delete[] this->m_InputBuffer;
-      delete[] this->m_OutputBuffer;
-    }
-    delete m_clQueue;
-    delete m_clContext;
-  }
+  virtual ~OpenCLComplexToComplex1DFFTImageFilter() = default;
 
   virtual void
   GenerateData(); // generates output from input
@@ -94,13 +96,12 @@ protected:
   Legaldim(int n);
 
 private:
-  bool                m_PlanComputed = false;
-  clfftPlanHandle     m_Plan = 0;
-  unsigned int        m_LastImageSize = 0;
-  OpenCLComplexType * m_InputBuffer = nullptr;
-  OpenCLComplexType * m_OutputBuffer = nullptr;
-  cl::Context *       m_clContext = nullptr;
-  cl::CommandQueue *  m_clQueue = nullptr;
+  using PipelineType = fft1d::OpenCLLinePipeline<TPixel>;
+
+  SizeValueType                 m_NumberOfLinesPerChunk = 0;
+  PipelineType                  m_Pipeline;
+  cl::Context                   m_clContext;
+  std::vector<cl::CommandQueue> m_clQueues;
 };
 
 } // namespace itk
@@ -20,13 +20,11 @@
 
 #  include "itkComplexToComplex1DFFTImageFilter.hxx"
 #  include "itkOpenCLComplexToComplex1DFFTImageFilter.h"
-#  include "itkclFFTInitializer.h"
 
 #  include <vector>
 
+#  include "itkFFT1DLineBatch.h"
 #  include "itkIndent.h"
-#  include "itkImageLinearConstIteratorWithIndex.h"
-#  include "itkImageLinearIteratorWithIndex.h"
 #  include "itkMetaDataObject.h"
 
 namespace itk
@@ -35,22 +33,14 @@ namespace itk
 template <typename TInputImage, typename TOutputImage>
 OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::OpenCLComplexToComplex1DFFTImageFilter()
 {
-  try
+  // the context of the device selected by the clFFTContextManager is shared
+  // by all the filters; a queue per slot of the pipeline, so that the
+  // transfers of a chunk of lines overlap the transform of the previous one
+  clFFTContextManager & manager = clFFTContextManager::GetInstance();
+  m_clContext = manager.GetContext();
+  for (unsigned int slot = 0; slot < PipelineType::NumberOfSlots; ++slot)
   {
-    auto initObject = clFFFInitialization();
-    m_clContext = new cl::Context(CL_DEVICE_TYPE_ALL);
-    std::vector<cl::Device> devices = m_clContext->getInfo<CL_CONTEXT_DEVICES>();
-    if (devices.size() < 1)
-    {
-      itkExceptionMacro("No OpenCL devices found.");
-    }
-    // @todo: code to select the fastest device, or the device that is
-    // CL_DEVICE_TYPE_ACCELERATOR
-    this->m_clQueue = new cl::CommandQueue(*m_clContext, devices[0]);
-  }
-  catch (const cl::Error & e)
-  {
-    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+    this->m_clQueues.push_back(manager.CreateQueue());
   }
 }
 
@@ -74,14 +64,14 @@ OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData(
     return;
   }
 
-  // allocate output buffer memory
-  outputPtr->SetBufferedRegion(outputPtr->GetRequestedRegion());
-  outputPtr->Allocate();
+  // allocate output buffer memory, or reuse the input buffer when running in
+  // place: the lines of a tile are gathered before they are overwritten
+  this->AllocateOutputs();
 
-  const typename InputImageType::SizeType &  inputSize = inputPtr->GetRequestedRegion().GetSize();
-  const typename OutputImageType::SizeType & outputSize = outputPtr->GetRequestedRegion().GetSize();
+  const unsigned int                           direction = this->m_Direction;
+  const typename OutputImageType::RegionType & outputRegion = outputPtr->GetRequestedRegion();
 
-  unsigned int vec_size = inputSize[this->m_Direction];
+  const SizeValueType vec_size = inputPtr->GetRequestedRegion().GetSize(direction);
   if (!this->Legaldim(vec_size))
   {
     ExceptionObject exception(__FILE__, __LINE__);
@@ -90,117 +80,35 @@ OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData(
     throw exception;
   }
 
-  cl_int batchSize = 1;
-  for (unsigned int i = 0; i < TInputImage::ImageDimension; i++)
-  {
-    batchSize *= outputSize[i];
-  }
-  unsigned int totalSize = batchSize;
-  batchSize /= outputSize[this->m_Direction];
-  cl_command_queue queue = (*m_clQueue)();
-
-  if (this->m_PlanComputed) // if we've already computed a plan
-  {
-    // if the image sizes aren't the same,
-    // we have to compute the plan again
-    if (this->m_LastImageSize != totalSize)
-    {
-      delete[] this->m_InputBuffer;
-      delete[] this->m_OutputBuffer;
-      clfftDestroyPlan(&this->m_Plan);
-      this->m_PlanComputed = false;
-    }
-  }
-  if (!this->m_PlanComputed)
-  {
-    try
-    {
-      this->m_InputBuffer = new OpenCLComplexType[totalSize];
-      this->m_OutputBuffer = new OpenCLComplexType[totalSize];
-    }
-    catch (std::bad_alloc &)
-    {
-      itkExceptionMacro("Problem allocating memory for internal computations");
-    }
-    this->m_LastImageSize = totalSize;
-    const size_t n[3] = { inputSize[this->GetDirection()], 1, 1 };
-    clfftStatus  error_code = clfftCreateDefaultPlan(&this->m_Plan, (*m_clContext)(), CLFFT_1D, n);
-    if (!this->m_Plan || error_code)
-    {
-      itkExceptionMacro("Could not create OpenCL FFT Plan.");
-    }
-
-    error_code = clfftSetResultLocation(this->m_Plan, CLFFT_INPLACE);
-    error_code = clfftSetPlanBatchSize(this->m_Plan, batchSize);
-    if (std::is_same<TPixel, double>::value) // float by default
-    {
-      error_code = clfftSetPlanPrecision(this->m_Plan, CLFFT_DOUBLE);
-    }
-    clfftBakePlan(this->m_Plan, 1, &queue, nullptr, nullptr);
-    this->m_PlanComputed = true;
-  }
-
-  using InputIteratorType = itk::ImageLinearConstIteratorWithIndex<InputImageType>;
-  using OutputIteratorType = itk::ImageLinearIteratorWithIndex<OutputImageType>;
-  InputIteratorType  inputIt(inputPtr, inputPtr->GetRequestedRegion());
-  OutputIteratorType outputIt(outputPtr, outputPtr->GetRequestedRegion());
-
-  inputIt.SetDirection(this->m_Direction);
-  outputIt.SetDirection(this->m_Direction);
-
-  OpenCLComplexType * inputBufferIt = this->m_InputBuffer;
-  // for every fft line
-  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); inputIt.NextLine())
-  {
-    // copy the input line into our buffer
-    inputIt.GoToBeginOfLine();
-    while (!inputIt.IsAtEndOfLine())
-    {
-      inputBufferIt->real(inputIt.Get().real());
-      inputBufferIt->imag(inputIt.Get().imag());
-      ++inputIt;
-      ++inputBufferIt;
-    }
-  }
-
-  try
-  {
-    // do the transform
-    cl::Buffer clDataBuffer(
-      *m_clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, totalSize * sizeof(TPixel) * 2, m_InputBuffer);
-    cl_mem      clPointer = clDataBuffer();
-    clfftStatus err;
-    if (this->m_TransformDirection == Superclass::DIRECT)
-      err = clfftEnqueueTransform(
-        this->m_Plan, CLFFT_FORWARD, 1, &queue, 0, nullptr, nullptr, &clPointer, nullptr, nullptr);
-    else
-      err = clfftEnqueueTransform(
-        this->m_Plan, CLFFT_BACKWARD, 1, &queue, 0, nullptr, nullptr, &clPointer, nullptr, nullptr);
-    if (err)
-    {
-      itkExceptionMacro("Error in clfftEnqueueTransform(" << err << ")");
-    }
-    cl_int err2 =
-      m_clQueue->enqueueReadBuffer(clDataBuffer, CL_TRUE, 0, totalSize * sizeof(TPixel) * 2, m_OutputBuffer);
-  }
-  catch (const cl::Error & e)
-  {
-    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
-  }
-
-  OpenCLComplexType * outputBufferIt = this->m_OutputBuffer;
-  // for every fft line
-  for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); outputIt.NextLine())
-  {
-    // copy the output line into our buffer
-    outputIt.GoToBeginOfLine();
-    while (!outputIt.IsAtEndOfLine())
-    {
-      outputIt.Set(*reinterpret_cast<typename OutputIteratorType::PixelType *>(outputBufferIt));
-      ++outputIt;
-      ++outputBufferIt;
-    }
-  }
+  // the lines are gathered and scattered a tile of adjacent lines at a time
+  using IndexType = typename OutputImageType::IndexType;
+  std::vector<IndexType>     tileStarts;
+  std::vector<SizeValueType> tileLines;
+  fft1d::ForEachLineTile(
+    outputRegion, direction, fft1d::MaximumLineTileSize, [&](const IndexType & tileStart, SizeValueType lines) {
+      tileStarts.push_back(tileStart);
+      tileLines.push_back(lines);
+    });
+  const SizeValueType numberOfLines = outputRegion.GetNumberOfPixels() / vec_size;
+
+  this->m_Pipeline.SetUp(m_clContext,
+                         m_clQueues,
+                         vec_size,
+                         PipelineType::ComputeLinesPerChunk(numberOfLines, this->m_NumberOfLinesPerChunk),
+                         true);
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  this->m_Pipeline.Transform(
+    this->m_TransformDirection == Superclass::DIRECT ? CLFFT_FORWARD : CLFFT_BACKWARD,
+    multiThreader,
+    tileLines,
+    [&](SizeValueType tile, OpenCLComplexType * buffer) {
+      fft1d::GatherLineTile(inputPtr.GetPointer(), tileStarts[tile], direction, vec_size, tileLines[tile], buffer);
+    },
+    [&](SizeValueType tile, OpenCLComplexType * buffer) {
+      fft1d::ScatterLineTile(outputPtr.GetPointer(), tileStarts[tile], direction, vec_size, tileLines[tile], buffer);
+    });
 }
 
 } // namespace itk
@@ -0,0 +1,287 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCLFFT1DLinePipeline_h) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCLFFT1DLinePipeline_h
+
+#  include "itkFFT1DLineBatch.h"
+#  include "itkFFT1DScratchArena.h"
+#  include "itkMacro.h"
+#  include "itkMultiThreaderBase.h"
+
+#  define __CL_ENABLE_EXCEPTIONS
+#  include "CL/cl.hpp"
+#  include "clFFT.h"
+
+#  include <algorithm>
+#  include <complex>
+#  include <type_traits>
+#  include <vector>
+
+namespace itk
+{
+namespace fft1d
+{
+
+/** \class OpenCLLinePipeline
+ * \brief Transform lines with clFFT a chunk of lines at a time, the transfers
+ * of a chunk overlapping the transform of the previous one.
+ *
+ * The pipeline keeps two slots, each with its device buffer, host staging
+ * buffer, command queue and plan, alive between the updates of a filter; they
+ * are only made again when the line size, the chunk size, the normalization
+ * or the context change. While the device transforms the chunk of a slot, the
+ * host gathers the next chunk into the other slot and enqueues its upload,
+ * transform and download without blocking, then scatters the chunk before
+ * last once its download completed. The gather and scatter run on the ITK
+ * multithreader, a tile of lines per work item.
+ *
+ * The lines are transformed in place, lineSize values apart in the buffers.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TReal>
+class OpenCLLinePipeline
+{
+public:
+  using ComplexType = std::complex<TReal>;
+
+  static constexpr unsigned int NumberOfSlots = 2;
+
+  OpenCLLinePipeline() = default;
+  ~OpenCLLinePipeline() { this->DestroyPlans(); }
+  OpenCLLinePipeline(const OpenCLLinePipeline &) = delete;
+  OpenCLLinePipeline &
+  operator=(const OpenCLLinePipeline &) = delete;
+
+  /** Get ready to transform lines of lineSize values, up to linesPerChunk at a
+   * time, on the device of context, with a queue per slot. The backward
+   * transform is scaled by 1 / lineSize when normalize is true. */
+  void
+  SetUp(const cl::Context &                   context,
+        const std::vector<cl::CommandQueue> & queues,
+        SizeValueType                         lineSize,
+        SizeValueType                         linesPerChunk,
+        bool                                  normalize)
+  {
+    if (m_PlansComputed && m_Context() == context() && m_LineSize == lineSize && m_LinesPerChunk == linesPerChunk &&
+        m_Normalize == normalize)
+    {
+      return;
+    }
+    this->DestroyPlans();
+    try
+    {
+      for (unsigned int slot = 0; slot < NumberOfSlots; ++slot)
+      {
+        m_Queues[slot] = queues[slot % queues.size()];
+        m_DeviceBuffers[slot] = cl::Buffer(context, CL_MEM_READ_WRITE, linesPerChunk * lineSize * sizeof(ComplexType));
+        m_HostBuffers[slot].Allocate(linesPerChunk * lineSize);
+      }
+    }
+    catch (const cl::Error & e)
+    {
+      itkGenericExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+    }
+    catch (std::bad_alloc &)
+    {
+      itkGenericExceptionMacro("Problem allocating memory for internal computations");
+    }
+
+    // a plan per slot, as the plans of some sizes have their own intermediate
+    // device buffer
+    const size_t n[3] = { lineSize, 1, 1 };
+    for (unsigned int slot = 0; slot < NumberOfSlots; ++slot)
+    {
+      clfftStatus error_code = clfftCreateDefaultPlan(&m_Plans[slot], context(), CLFFT_1D, n);
+      if (!m_Plans[slot] || error_code)
+      {
+        this->DestroyPlans();
+        itkGenericExceptionMacro("Could not create OpenCL FFT Plan.");
+      }
+      clfftSetResultLocation(m_Plans[slot], CLFFT_INPLACE);
+      clfftSetPlanBatchSize(m_Plans[slot], linesPerChunk);
+      if (std::is_same<TReal, double>::value) // float by default
+      {
+        clfftSetPlanPrecision(m_Plans[slot], CLFFT_DOUBLE);
+      }
+      if (!normalize) // clFFT scales the backward transform by 1/N by default
+      {
+        clfftSetPlanScale(m_Plans[slot], CLFFT_BACKWARD, 1.0f);
+      }
+      cl_command_queue queue = m_Queues[slot]();
+      error_code = clfftBakePlan(m_Plans[slot], 1, &queue, nullptr, nullptr);
+      if (error_code)
+      {
+        this->DestroyPlans();
+        itkGenericExceptionMacro("Could not bake OpenCL FFT Plan (" << error_code << ")");
+      }
+    }
+    m_Context = context;
+    m_LineSize = lineSize;
+    m_LinesPerChunk = linesPerChunk;
+    m_Normalize = normalize;
+    m_PlansComputed = true;
+  }
+
+  /** Transform the lines of tiles of tileLines[tile] lines each. Consecutive
+   * tiles are grouped into chunks of up to the linesPerChunk of SetUp(), so a
+   * tile may not have more lines than that. gather(tile, buffer) copies the
+   * lines of a tile into buffer, lineSize values apart, and scatter(tile,
+   * buffer) copies them out of it after the transform; the buffer may be
+   * modified by scatter. */
+  template <typename TGatherFunction, typename TScatterFunction>
+  void
+  Transform(clfftDirection                     direction,
+            MultiThreaderBase *                multiThreader,
+            const std::vector<SizeValueType> & tileLines,
+            TGatherFunction                    gather,
+            TScatterFunction                   scatter)
+  {
+    // the chunks of consecutive tiles, and the line of each tile in its chunk
+    std::vector<SizeValueType> chunkFirstTiles;
+    std::vector<SizeValueType> chunkLines;
+    std::vector<SizeValueType> tileFirstLines(tileLines.size());
+    for (SizeValueType tile = 0; tile < tileLines.size(); ++tile)
+    {
+      if (chunkLines.empty() || chunkLines.back() + tileLines[tile] > m_LinesPerChunk)
+      {
+        chunkFirstTiles.push_back(tile);
+        chunkLines.push_back(0);
+      }
+      tileFirstLines[tile] = chunkLines.back();
+      chunkLines.back() += tileLines[tile];
+    }
+    chunkFirstTiles.push_back(tileLines.size());
+
+    const auto forEachTile = [&](SizeValueType chunk, unsigned int slot, bool scatterTiles) {
+      ComplexType * buffer = m_HostBuffers[slot].data();
+      multiThreader->ParallelizeArray(
+        chunkFirstTiles[chunk],
+        chunkFirstTiles[chunk + 1],
+        [&](SizeValueType tile) {
+          ComplexType * tileBuffer = buffer + tileFirstLines[tile] * m_LineSize;
+          if (scatterTiles)
+          {
+            scatter(tile, tileBuffer);
+          }
+          else
+          {
+            gather(tile, tileBuffer);
+          }
+        },
+        nullptr);
+    };
+
+    cl::Event     downloads[NumberOfSlots];
+    bool          pending[NumberOfSlots] = { false, false };
+    SizeValueType pendingChunks[NumberOfSlots] = { 0, 0 };
+    try
+    {
+      for (SizeValueType chunk = 0; chunk < chunkLines.size(); ++chunk)
+      {
+        const unsigned int slot = chunk % NumberOfSlots;
+        // the slot is free once the chunk before last is back on the host
+        if (pending[slot])
+        {
+          downloads[slot].wait();
+          forEachTile(pendingChunks[slot], slot, true);
+          pending[slot] = false;
+        }
+        forEachTile(chunk, slot, false);
+
+        // only the lines of the chunk are transferred; the plan transforms the
+        // leftovers of the previous chunks past them as well
+        const SizeValueType bytes = chunkLines[chunk] * m_LineSize * sizeof(ComplexType);
+        cl::CommandQueue &  queue = m_Queues[slot];
+        queue.enqueueWriteBuffer(m_DeviceBuffers[slot], CL_FALSE, 0, bytes, m_HostBuffers[slot].data());
+        cl_command_queue queueHandle = queue();
+        cl_mem           bufferHandle = m_DeviceBuffers[slot]();
+        clfftStatus      err = clfftEnqueueTransform(
+          m_Plans[slot], direction, 1, &queueHandle, 0, nullptr, nullptr, &bufferHandle, nullptr, nullptr);
+        if (err)
+        {
+          itkGenericExceptionMacro("Error in clfftEnqueueTransform(" << err << ")");
+        }
+        queue.enqueueReadBuffer(
+          m_DeviceBuffers[slot], CL_FALSE, 0, bytes, m_HostBuffers[slot].data(), nullptr, &downloads[slot]);
+        queue.flush();
+        pending[slot] = true;
+        pendingChunks[slot] = chunk;
+      }
+      // scatter the last chunks in order
+      for (SizeValueType chunk = chunkLines.size() > NumberOfSlots ? chunkLines.size() - NumberOfSlots : 0;
+           chunk < chunkLines.size();
+           ++chunk)
+      {
+        const unsigned int slot = chunk % NumberOfSlots;
+        downloads[slot].wait();
+        forEachTile(chunk, slot, true);
+        pending[slot] = false;
+      }
+    }
+    catch (const cl::Error & e)
+    {
+      for (cl::CommandQueue & queue : m_Queues)
+      {
+        queue.finish();
+      }
+      itkGenericExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+    }
+  }
+
+  /** Number of lines per chunk for numberOfLines lines, when
+   * requestedLinesPerChunk are requested, or a quarter of the lines for 0; a
+   * chunk holds at least a full tile of MaximumLineTileSize lines. */
+  static SizeValueType
+  ComputeLinesPerChunk(SizeValueType numberOfLines, SizeValueType requestedLinesPerChunk)
+  {
+    const SizeValueType quarter = (numberOfLines + 3) / 4;
+    const SizeValueType linesPerChunk = requestedLinesPerChunk > 0 ? requestedLinesPerChunk : quarter;
+    return std::max(std::min(numberOfLines, MaximumLineTileSize), std::min(numberOfLines, linesPerChunk));
+  }
+
+private:
+  void
+  DestroyPlans()
+  {
+    for (clfftPlanHandle & plan : m_Plans)
+    {
+      if (plan)
+      {
+        clfftDestroyPlan(&plan);
+        plan = 0;
+      }
+    }
+    m_PlansComputed = false;
+  }
+
+  bool                       m_PlansComputed = false;
+  cl::Context                m_Context;
+  SizeValueType              m_LineSize = 0;
+  SizeValueType              m_LinesPerChunk = 0;
+  bool                       m_Normalize = true;
+  clfftPlanHandle            m_Plans[NumberOfSlots] = { 0, 0 };
+  cl::CommandQueue           m_Queues[NumberOfSlots];
+  cl::Buffer                 m_DeviceBuffers[NumberOfSlots];
+  ScratchBuffer<ComplexType> m_HostBuffers[NumberOfSlots];
+};
+
+} // end namespace fft1d
+} // end namespace itk
+
+#endif // itkOpenCLFFT1DLinePipeline_h
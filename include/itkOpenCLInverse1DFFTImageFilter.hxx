@@ -20,13 +20,11 @@
 
 #  include "itkInverse1DFFTImageFilter.hxx"
 #  include "itkOpenCLInverse1DFFTImageFilter.h"
-#  include "itkclFFTInitializer.h"
 
 #  include <vector>
 
+#  include "itkFFT1DLineBatch.h"
 #  include "itkIndent.h"
-#  include "itkImageLinearConstIteratorWithIndex.h"
-#  include "itkImageLinearIteratorWithIndex.h"
 #  include "itkMetaDataObject.h"
 
 namespace itk
@@ -35,22 +33,14 @@ namespace itk
 template <typename TInputImage, typename TOutputImage>
 OpenCLInverse1DFFTImageFilter<TInputImage, TOutputImage>::OpenCLInverse1DFFTImageFilter()
 {
-  try
+  // the context of the device selected by the clFFTContextManager is shared
+  // by all the filters; a queue per slot of the pipeline, so that the
+  // transfers of a chunk of lines overlap the transform of the previous one
+  clFFTContextManager & manager = clFFTContextManager::GetInstance();
+  m_clContext = manager.GetContext();
+  for (unsigned int slot = 0; slot < PipelineType::NumberOfSlots; ++slot)
   {
-    auto initObject = clFFFInitialization();
-    m_clContext = new cl::Context(CL_DEVICE_TYPE_ALL);
-    std::vector<cl::Device> devices = m_clContext->getInfo<CL_CONTEXT_DEVICES>();
-    if (devices.size() < 1)
-    {
-      itkExceptionMacro("No OpenCL devices found.");
-    }
-    // @todo: code to select the fastest device, or the device that is
-    // CL_DEVICE_TYPE_ACCELERATOR
-    this->m_clQueue = new cl::CommandQueue(*m_clContext, devices[0]);
-  }
-  catch (const cl::Error & e)
-  {
-    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+    this->m_clQueues.push_back(manager.CreateQueue());
   }
 }
 
@@ -78,10 +68,11 @@ OpenCLInverse1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
   outputPtr->SetBufferedRegion(outputPtr->GetRequestedRegion());
   outputPtr->Allocate();
 
-  const typename InputImageType::SizeType &  inputSize = inputPtr->GetRequestedRegion().GetSize();
-  const typename OutputImageType::SizeType & outputSize = outputPtr->GetRequestedRegion().GetSize();
+  const unsigned int                           direction = this->m_Direction;
+  const typename InputImageType::RegionType &  inputRegion = inputPtr->GetRequestedRegion();
+  const typename OutputImageType::RegionType & outputRegion = outputPtr->GetRequestedRegion();
 
-  unsigned int vec_size = inputSize[this->m_Direction];
+  const SizeValueType vec_size = outputRegion.GetSize(direction);
   if (!this->Legaldim(vec_size))
   {
     ExceptionObject exception(__FILE__, __LINE__);
@@ -89,112 +80,63 @@ OpenCLInverse1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
     exception.SetLocation(ITK_LOCATION);
     throw exception;
   }
-
-  cl_int batchSize = 1;
-  for (unsigned int i = 0; i < TInputImage::ImageDimension; i++)
-  {
-    batchSize *= outputSize[i];
-  }
-  unsigned int totalSize = batchSize;
-  batchSize /= outputSize[this->m_Direction];
-  cl_command_queue queue = (*m_clQueue)();
-
-  if (this->m_PlanComputed) // if we've already computed a plan
-  {
-    // if the image sizes aren't the same,
-    // we have to compute the plan again
-    if (this->m_LastImageSize != totalSize)
-    {
-      delete[] this->m_InputBuffer;
-      delete[] this->m_OutputBuffer;
-      clfftDestroyPlan(&this->m_Plan);
-      this->m_PlanComputed = false;
-    }
-  }
-  if (!this->m_PlanComputed)
-  {
-    try
-    {
-      this->m_InputBuffer = new OpenCLComplexType[totalSize];
-      this->m_OutputBuffer = new OpenCLComplexType[totalSize];
-    }
-    catch (std::bad_alloc &)
-    {
-      itkExceptionMacro("Problem allocating memory for internal computations");
-    }
-    this->m_LastImageSize = totalSize;
-    const size_t n[3] = { inputSize[this->GetDirection()], 1, 1 };
-    clfftStatus  error_code = clfftCreateDefaultPlan(&this->m_Plan, (*m_clContext)(), CLFFT_1D, n);
-    if (!this->m_Plan || error_code)
-    {
-      itkExceptionMacro("Could not create OpenCL FFT Plan.");
-    }
-    error_code = clfftSetResultLocation(this->m_Plan, CLFFT_INPLACE);
-    error_code = clfftSetPlanBatchSize(this->m_Plan, batchSize);
-    if (std::is_same<TPixel, double>::value) // float by default
-    {
-      error_code = clfftSetPlanPrecision(this->m_Plan, CLFFT_DOUBLE);
-    }
-    clfftBakePlan(this->m_Plan, 1, &queue, nullptr, nullptr);
-    this->m_PlanComputed = true;
-  }
-
-  using InputIteratorType = itk::ImageLinearConstIteratorWithIndex<InputImageType>;
-  using OutputIteratorType = itk::ImageLinearIteratorWithIndex<OutputImageType>;
-  InputIteratorType  inputIt(inputPtr, inputPtr->GetRequestedRegion());
-  OutputIteratorType outputIt(outputPtr, outputPtr->GetRequestedRegion());
-
-  inputIt.SetDirection(this->m_Direction);
-  outputIt.SetDirection(this->m_Direction);
-
-  OpenCLComplexType * inputBufferIt = this->m_InputBuffer;
-  // for every fft line
-  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); inputIt.NextLine())
-  {
-    // copy the input line into our buffer
-    inputIt.GoToBeginOfLine();
-    while (!inputIt.IsAtEndOfLine())
-    {
-      inputBufferIt->real(inputIt.Get().real());
-      inputBufferIt->imag(inputIt.Get().imag());
-      ++inputIt;
-      ++inputBufferIt;
-    }
-  }
-
-  try
-  {
-    // do the transform
-    cl::Buffer clDataBuffer(
-      *m_clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, totalSize * sizeof(TPixel) * 2, m_InputBuffer);
-    cl_mem      clPointer = clDataBuffer();
-    clfftStatus err =
-      clfftEnqueueTransform(this->m_Plan, CLFFT_BACKWARD, 1, &queue, 0, nullptr, nullptr, &clPointer, nullptr, nullptr);
-    if (err)
-    {
-      itkExceptionMacro("Error in clfftEnqueueTransform(" << err << ")");
-    }
-    cl_int err2 =
-      m_clQueue->enqueueReadBuffer(clDataBuffer, CL_TRUE, 0, totalSize * sizeof(TPixel) * 2, m_OutputBuffer);
-  }
-  catch (const cl::Error & e)
-  {
-    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
-  }
-
-  OpenCLComplexType * outputBufferIt = this->m_OutputBuffer;
-  // for every fft line
-  for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); outputIt.NextLine())
-  {
-    // copy the output line into our buffer
-    outputIt.GoToBeginOfLine();
-    while (!outputIt.IsAtEndOfLine())
-    {
-      outputIt.Set(outputBufferIt->real());
-      ++outputIt;
-      ++outputBufferIt;
-    }
-  }
+  // the input lines only hold the non-negative frequencies in HalfSpectrum
+  // mode, and only those are read from Hermitian input lines
+  const SizeValueType inputLineSize =
+    this->m_HermitianInput ? vec_size / 2 + 1 : inputRegion.GetSize(direction);
+
+  // the lines are gathered and scattered a tile of adjacent lines at a time
+  using IndexType = typename OutputImageType::IndexType;
+  std::vector<IndexType>     tileStarts;
+  std::vector<SizeValueType> tileLines;
+  fft1d::ForEachLineTile(
+    outputRegion, direction, fft1d::MaximumLineTileSize, [&](const IndexType & tileStart, SizeValueType lines) {
+      tileStarts.push_back(tileStart);
+      tileLines.push_back(lines);
+    });
+  const SizeValueType numberOfLines = outputRegion.GetNumberOfPixels() / vec_size;
+
+  this->m_Pipeline.SetUp(m_clContext,
+                         m_clQueues,
+                         vec_size,
+                         PipelineType::ComputeLinesPerChunk(numberOfLines, this->m_NumberOfLinesPerChunk),
+                         this->m_Normalize);
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  const IndexValueType inputLineStart = inputRegion.GetIndex(direction);
+  this->m_Pipeline.Transform(
+    CLFFT_BACKWARD,
+    multiThreader,
+    tileLines,
+    [&](SizeValueType tile, OpenCLComplexType * buffer) {
+      typename InputImageType::IndexType inputTileStart = tileStarts[tile];
+      inputTileStart[direction] = inputLineStart;
+      fft1d::GatherLineTile(
+        inputPtr.GetPointer(), inputTileStart, direction, inputLineSize, tileLines[tile], buffer, vec_size);
+      // fill in the negative frequencies from the Hermitian symmetry in
+      // HalfSpectrum mode, or with HermitianInput on
+      for (SizeValueType line = 0; line < tileLines[tile]; ++line)
+      {
+        OpenCLComplexType * lineBuffer = buffer + line * vec_size;
+        for (SizeValueType k = inputLineSize; k < vec_size; ++k)
+        {
+          lineBuffer[k] = std::conj(lineBuffer[vec_size - k]);
+        }
+      }
+    },
+    [&](SizeValueType tile, OpenCLComplexType * buffer) {
+      // pack the real parts at the beginning of the tile buffer; each value is
+      // read before it is overwritten
+      TPixel *            realBuffer = reinterpret_cast<TPixel *>(buffer);
+      const SizeValueType numberOfValues = tileLines[tile] * vec_size;
+      for (SizeValueType ii = 0; ii < numberOfValues; ++ii)
+      {
+        realBuffer[ii] = buffer[ii].real();
+      }
+      fft1d::ScatterLineTile(
+        outputPtr.GetPointer(), tileStarts[tile], direction, vec_size, tileLines[tile], realBuffer);
+    });
 }
 
 } // namespace itk
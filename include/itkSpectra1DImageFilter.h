@@ -22,9 +22,10 @@
 #include "itkDefaultConvertPixelTraits.h"
 #include "itkImageRegionConstIterator.h"
 
-#include "vnl/algo/vnl_fft_base.h"
-#include "vnl/algo/vnl_fft_1d.h"
+#include "itkNativeFFT1D.h"
+#include "vnl/vnl_vector.h"
 
+#include <memory>
 #include <utility>
 
 #include <unordered_map>
@@ -48,7 +49,9 @@ namespace itk
  * bins on the range (0,nyquist] with DC content discarded.
  *
  * FFT is computed in each support window using a Hamming window. A reference spectra
- * image may be provided to compensate for system noise.
+ * image may be provided to compensate for system noise. The transforms run on
+ * the fixed length kernels of fft1d::FixedLengthFFT for the power of two
+ * window sizes they cover.
  *
  * This filter expects that beam input lies along the zeroth dimension and lateral lines
  * lie along the first dimension. Images not matching this description may be permuted
@@ -116,7 +119,7 @@ private:
   using SpectraLinesContainerType = std::list<SpectraLineType>;
   using SupportWindowType = typename SupportWindowImageType::PixelType;
   using InputImageIteratorType = ImageRegionConstIterator<InputImageType>;
-  using FFT1DType = vnl_fft_1d<ScalarType>;
+  using FFT1DType = fft1d::NativeFFT<ScalarType>;
 
   using Spectra1DSupportWindowFilterType = Spectra1DSupportWindowImageFilter<InputImageType>;
   using FFT1DSizeType = typename Spectra1DSupportWindowFilterType::FFT1DSizeType;
@@ -126,6 +129,8 @@ private:
   struct PerThreadData
   {
     ComplexVectorType                 ComplexVector;
+    ComplexVectorType                 SpectrumVector;
+    ComplexVectorType                 WorkVector;
     SpectraVectorType                 SpectraVector;
     typename InputImageType::SizeType LineImageRegionSize;
     LineWindowMapType                 LineWindowMap;
@@ -133,6 +138,9 @@ private:
   using PerThreadDataContainerType = std::vector<PerThreadData>;
   PerThreadDataContainerType m_PerThreadDataContainer;
 
+  /** Shared by the threads, which only read it. */
+  std::unique_ptr<const FFT1DType> m_FFT1D;
+
   typename OutputImageType::Pointer m_ReferenceSpectraImage;
 
   void
@@ -77,12 +77,23 @@ Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::BeforeThre
   // with 50% overlap. Subtract one for discarding DC component.
   const FFT1DSizeType spectraComponents = fft1DSize / 2 / 2 - 1;
 
+  if (!FFT1DType::IsSizeSupported(fft1DSize / 2))
+  {
+    itkExceptionMacro("Unsupported FFT1DSize " << fft1DSize);
+  }
+  if (!this->m_FFT1D || this->m_FFT1D->GetSize() != fft1DSize / 2)
+  {
+    this->m_FFT1D.reset(new FFT1DType(fft1DSize / 2));
+  }
+
   const ThreadIdType numberOfWorkUnits = this->GetNumberOfWorkUnits();
   this->m_PerThreadDataContainer.resize(numberOfWorkUnits);
   for (ThreadIdType threadId = 0; threadId < numberOfWorkUnits; ++threadId)
   {
     PerThreadData & perThreadData = this->m_PerThreadDataContainer[threadId];
     perThreadData.ComplexVector.set_size(fft1DSize / 2);
+    perThreadData.SpectrumVector.set_size(fft1DSize / 2);
+    perThreadData.WorkVector.set_size(this->m_FFT1D->GetWorkSize());
     perThreadData.SpectraVector.resize(spectraComponents);
     perThreadData.LineImageRegionSize.Fill(1);
     perThreadData.LineImageRegionSize[0] = fft1DSize;
@@ -139,7 +150,7 @@ Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::ComputeSpe
   typename ComplexVectorType::iterator       complexVectorIt = perThreadData.ComplexVector.begin();
   const typename ComplexVectorType::iterator complexVectorEnd = perThreadData.ComplexVector.end();
   typename SpectraVectorType::const_iterator windowIt = perThreadData.LineWindowMap[fftSize].begin();
-  typename ComplexVectorType::const_iterator complexVectorConstIt = perThreadData.ComplexVector.begin();
+  typename ComplexVectorType::const_iterator complexVectorConstIt = perThreadData.SpectrumVector.begin();
   typename SpectraVectorType::iterator       spectraVectorIt = perThreadData.SpectraVector.begin();
   const size_t                               highFreq = perThreadData.SpectraVector.size();
   for (size_t freq = 0; freq < highFreq; ++freq)
@@ -164,9 +175,10 @@ Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::ComputeSpe
       ++complexVectorIt;
       ++windowIt;
     }
-    FFT1DType fft1D(fftSize);
-    fft1D.bwd_transform(perThreadData.ComplexVector);
-    complexVectorConstIt = perThreadData.ComplexVector.begin();
+    this->m_FFT1D->Forward(perThreadData.ComplexVector.data_block(),
+                           perThreadData.SpectrumVector.data_block(),
+                           perThreadData.WorkVector.data_block());
+    complexVectorConstIt = perThreadData.SpectrumVector.begin();
     spectraVectorIt = perThreadData.SpectraVector.begin();
     // drop DC component
     ++complexVectorConstIt;
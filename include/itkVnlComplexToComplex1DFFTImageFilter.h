@@ -29,6 +29,9 @@ namespace itk
  * \brief Perform the FFT along one dimension of an image using Vnl as a
  * backend.
  *
+ * vnl handles the line sizes with prime factors up to 5; the other sizes are
+ * transformed with Bluestein's algorithm, as in fft1d::NativeFFT.
+ *
  * \ingroup Ultrasound
  */
 template <typename TInputImage, typename TOutputImage>
@@ -56,6 +59,12 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(VnlComplexToComplex1DFFTImageFilter, ComplexToComplex1DFFTImageFilter);
 
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const override
+  {
+    return 5;
+  }
+
 protected:
   VnlComplexToComplex1DFFTImageFilter() {}
   virtual ~VnlComplexToComplex1DFFTImageFilter() {}
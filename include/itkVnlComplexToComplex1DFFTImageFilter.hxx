@@ -21,13 +21,19 @@
 #include "itkVnlComplexToComplex1DFFTImageFilter.h"
 
 #include "itkComplexToComplex1DFFTImageFilter.hxx"
-#include "itkImageLinearConstIteratorWithIndex.h"
-#include "itkImageLinearIteratorWithIndex.h"
+#include "itkFFT1DLineBatch.h"
 #include "itkIndent.h"
 #include "itkMetaDataObject.h"
 #include "itkMacro.h"
+#include "itkNativeFFT1D.h"
+#include "itkVnlFFTCommon.h"
 #include "vnl/algo/vnl_fft_base.h"
 #include "vnl/algo/vnl_fft_1d.h"
+#include "vnl/vnl_vector_ref.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 namespace itk
 {
@@ -47,69 +53,89 @@ VnlComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
   const unsigned int direction = this->GetDirection();
   const unsigned int vectorSize = inputSize[direction];
 
+  // vnl only handles sizes with prime factors up to 5, the other sizes go
+  // through Bluestein's algorithm
+  using ValueType = typename NumericTraits<typename TInputImage::PixelType>::ValueType;
+  using BluesteinFFTType = fft1d::NativeFFT<ValueType>;
+  std::unique_ptr<const BluesteinFFTType> bluesteinFFT;
+  if (!VnlFFTCommon::IsDimensionSizeLegal(vectorSize))
+  {
+    bluesteinFFT.reset(new BluesteinFFTType(vectorSize));
+  }
+
   MultiThreaderBase * multiThreader = this->GetMultiThreader();
   multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
   multiThreader->template ParallelizeImageRegionRestrictDirection<TOutputImage::ImageDimension>(
     direction,
     output->GetRequestedRegion(),
-    [this, input, output, direction, vectorSize](const typename OutputImageType::RegionType & lambdaRegion) {
-      using InputIteratorType = ImageLinearConstIteratorWithIndex<InputImageType>;
-      using OutputIteratorType = ImageLinearIteratorWithIndex<OutputImageType>;
-      InputIteratorType  inputIt(input, lambdaRegion);
-      OutputIteratorType outputIt(output, lambdaRegion);
-
-      inputIt.SetDirection(direction);
-      outputIt.SetDirection(direction);
-
+    [this, input, output, direction, vectorSize, &bluesteinFFT](
+      const typename OutputImageType::RegionType & lambdaRegion) {
       using PixelType = typename TInputImage::PixelType;
-      using VNLVectorType = vnl_vector<PixelType>;
-      VNLVectorType                    inputBuffer(vectorSize);
-      typename VNLVectorType::iterator inputBufferIt = inputBuffer.begin();
-      // fft is done in-place
-      typename VNLVectorType::iterator                         outputBufferIt = inputBuffer.begin();
-      vnl_fft_1d<typename NumericTraits<PixelType>::ValueType> v1d(vectorSize);
-
-      // for every fft line
-      for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); outputIt.NextLine(), inputIt.NextLine())
+      // buffers of a tile of lines, see fft1d::ForEachLineTile; fft is done
+      // in-place
+      std::vector<PixelType>                 tileBuffer(fft1d::MaximumLineTileSize * vectorSize);
+      std::unique_ptr<vnl_fft_1d<ValueType>> v1d;
+      std::vector<std::complex<ValueType>>   bluesteinOutputBuffer;
+      std::vector<std::complex<ValueType>>   bluesteinWorkBuffer;
+      if (bluesteinFFT)
       {
-        // copy the input line into our buffer
-        inputIt.GoToBeginOfLine();
-        inputBufferIt = inputBuffer.begin();
-        while (!inputIt.IsAtEndOfLine())
-        {
-          *inputBufferIt = inputIt.Get();
-          ++inputIt;
-          ++inputBufferIt;
-        }
-
-        // do the transform
-        if (this->m_TransformDirection == Superclass::DIRECT)
-        {
-          v1d.bwd_transform(inputBuffer);
-          // copy the output from the buffer into our line
-          outputBufferIt = inputBuffer.begin();
-          outputIt.GoToBeginOfLine();
-          while (!outputIt.IsAtEndOfLine())
-          {
-            outputIt.Set(*outputBufferIt);
-            ++outputIt;
-            ++outputBufferIt;
-          }
-        }
-        else // m_TransformDirection == INVERSE
-        {
-          v1d.fwd_transform(inputBuffer);
-          // copy the output from the buffer into our line
-          outputBufferIt = inputBuffer.begin();
-          outputIt.GoToBeginOfLine();
-          while (!outputIt.IsAtEndOfLine())
+        bluesteinOutputBuffer.resize(vectorSize);
+        bluesteinWorkBuffer.resize(bluesteinFFT->GetWorkSize());
+      }
+      else
+      {
+        v1d.reset(new vnl_fft_1d<ValueType>(vectorSize));
+      }
+      const bool inverse = this->m_TransformDirection == Superclass::INVERSE;
+
+      fft1d::ForEachLineTile(
+        lambdaRegion,
+        direction,
+        fft1d::MaximumLineTileSize,
+        [&](const typename OutputImageType::IndexType & tileStart, SizeValueType numberOfLines) {
+          fft1d::GatherLineTile(input, tileStart, direction, vectorSize, numberOfLines, tileBuffer.data());
+
+          for (SizeValueType line = 0; line < numberOfLines; ++line)
           {
-            outputIt.Set((*outputBufferIt) / static_cast<PixelType>(vectorSize));
-            ++outputIt;
-            ++outputBufferIt;
+            PixelType * lineBuffer = tileBuffer.data() + line * vectorSize;
+
+            // do the transform
+            if (bluesteinFFT)
+            {
+              if (inverse)
+              {
+                bluesteinFFT->Backward(lineBuffer, bluesteinOutputBuffer.data(), bluesteinWorkBuffer.data());
+              }
+              else
+              {
+                bluesteinFFT->Forward(lineBuffer, bluesteinOutputBuffer.data(), bluesteinWorkBuffer.data());
+              }
+              std::copy(bluesteinOutputBuffer.begin(), bluesteinOutputBuffer.end(), lineBuffer);
+            }
+            else
+            {
+              vnl_vector_ref<PixelType> lineVector(vectorSize, lineBuffer);
+              if (inverse)
+              {
+                v1d->fwd_transform(lineVector);
+              }
+              else
+              {
+                v1d->bwd_transform(lineVector);
+              }
+            }
+
+            if (inverse)
+            {
+              for (SizeValueType k = 0; k < vectorSize; ++k)
+              {
+                lineBuffer[k] /= static_cast<PixelType>(vectorSize);
+              }
+            }
           }
-        }
-      }
+
+          fft1d::ScatterLineTile(output, tileStart, direction, vectorSize, numberOfLines, tileBuffer.data());
+        });
     },
     this);
 }
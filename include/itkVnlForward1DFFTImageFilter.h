@@ -29,10 +29,15 @@ namespace itk
  * \brief Perform the FFT along one dimension of an image using Vnl as a
  * backend.
  *
+ * vnl handles the line sizes with prime factors up to 5; the other sizes are
+ * transformed with Bluestein's algorithm, as in fft1d::NativeFFT.
+ *
  * \ingroup Ultrasound
  */
 template <typename TInputImage,
-          typename TOutputImage = Image<std::complex<typename TInputImage::PixelType>, TInputImage::ImageDimension>>
+          typename TOutputImage =
+            Image<std::complex<typename fft1d::RealFFTPrecision<typename TInputImage::PixelType>::Type>,
+                  TInputImage::ImageDimension>>
 class ITK_TEMPLATE_EXPORT VnlForward1DFFTImageFilter : public Forward1DFFTImageFilter<TInputImage, TOutputImage>
 {
 public:
@@ -54,6 +59,12 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(VnlForward1DFFTImageFilter, Forward1DFFTImageFilter);
 
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const override
+  {
+    return 5;
+  }
+
 protected:
   void
   GenerateData() override;
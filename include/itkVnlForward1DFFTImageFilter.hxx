@@ -20,15 +20,20 @@
 
 #include "itkVnlForward1DFFTImageFilter.h"
 
+#include "itkFFT1DLineBatch.h"
 #include "itkForward1DFFTImageFilter.hxx"
-#include "itkImageLinearConstIteratorWithIndex.h"
-#include "itkImageLinearIteratorWithIndex.h"
 #include "itkIndent.h"
 #include "itkMetaDataObject.h"
 #include "itkMacro.h"
+#include "itkNativeFFT1D.h"
 #include "itkVnlFFTCommon.h"
 #include "vnl/algo/vnl_fft_base.h"
 #include "vnl/algo/vnl_fft_1d.h"
+#include "vnl/vnl_vector_ref.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 namespace itk
 {
@@ -45,63 +50,95 @@ VnlForward1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
 
   const typename Superclass::InputImageType::SizeType & inputSize = input->GetRequestedRegion().GetSize();
 
-  const unsigned int direction = this->GetDirection();
-  unsigned int       vectorSize = inputSize[direction];
+  const unsigned int  direction = this->GetDirection();
+  const SizeValueType inputLineSize = inputSize[direction];
+  // the input lines are zero padded up to the transform size in the line
+  // buffers
+  const unsigned int vectorSize = this->GetTransformLineSize();
+  // the whole spectrum is computed, and only the band is kept when there is
+  // one
+  const SizeValueType firstBin = this->GetFirstOutputBin();
+
+  // integer input pixels are converted to the output precision when the
+  // lines are gathered
+  using PixelType = typename NumericTraits<typename TOutputImage::PixelType>::ValueType;
+  // vnl only handles sizes with prime factors up to 5, the other sizes go
+  // through Bluestein's algorithm
+  using BluesteinFFTType = fft1d::NativeFFT<PixelType>;
+  std::unique_ptr<const BluesteinFFTType> bluesteinFFT;
   if (!VnlFFTCommon::IsDimensionSizeLegal(vectorSize))
   {
-    itkExceptionMacro("Illegal Array DIM for FFT");
+    bluesteinFFT.reset(new BluesteinFFTType(vectorSize));
   }
 
-
   MultiThreaderBase * multiThreader = this->GetMultiThreader();
   multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
   multiThreader->template ParallelizeImageRegionRestrictDirection<TOutputImage::ImageDimension>(
     direction,
     output->GetRequestedRegion(),
-    [this, input, output, direction, vectorSize](const typename OutputImageType::RegionType & lambdaRegion) {
-      using InputIteratorType = ImageLinearConstIteratorWithIndex<InputImageType>;
-      using OutputIteratorType = ImageLinearIteratorWithIndex<OutputImageType>;
-      InputIteratorType  inputIt(input, lambdaRegion);
-      OutputIteratorType outputIt(output, lambdaRegion);
-
-      inputIt.SetDirection(direction);
-      outputIt.SetDirection(direction);
-
-      using PixelType = typename TInputImage::PixelType;
+    [this, input, output, direction, inputLineSize, vectorSize, firstBin, &bluesteinFFT](
+      const typename OutputImageType::RegionType & lambdaRegion) {
       using ComplexType = std::complex<PixelType>;
-      using ComplexVectorType = vnl_vector<ComplexType>;
-      ComplexVectorType                    inputBuffer(vectorSize);
-      typename ComplexVectorType::iterator inputBufferIt = inputBuffer.begin();
-      // fft is done in-place
-      typename ComplexVectorType::iterator outputBufferIt = inputBuffer.begin();
-      vnl_fft_1d<PixelType>                v1d(vectorSize);
-
-      // for every fft line
-      for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); outputIt.NextLine(), inputIt.NextLine())
+      // the output lines are shorter than the input ones in HalfSpectrum mode
+      // or with a band
+      const SizeValueType  outputLineSize = lambdaRegion.GetSize(direction);
+      const IndexValueType inputLineStart = input->GetRequestedRegion().GetIndex(direction);
+
+      // buffers of a tile of lines, see fft1d::ForEachLineTile; fft is done
+      // in-place
+      std::vector<ComplexType>               tileBuffer(fft1d::MaximumLineTileSize * vectorSize);
+      std::unique_ptr<vnl_fft_1d<PixelType>> v1d;
+      std::vector<ComplexType>               bluesteinOutputBuffer;
+      std::vector<ComplexType>               bluesteinWorkBuffer;
+      if (bluesteinFFT)
       {
-        // copy the input line into our buffer
-        inputIt.GoToBeginOfLine();
-        inputBufferIt = inputBuffer.begin();
-        while (!inputIt.IsAtEndOfLine())
-        {
-          *inputBufferIt = inputIt.Value();
-          ++inputIt;
-          ++inputBufferIt;
-        }
-
-        // do the transform
-        v1d.bwd_transform(inputBuffer);
-
-        // copy the output from the buffer into our line
-        outputBufferIt = inputBuffer.begin();
-        outputIt.GoToBeginOfLine();
-        while (!outputIt.IsAtEndOfLine())
-        {
-          outputIt.Set(*outputBufferIt);
-          ++outputIt;
-          ++outputBufferIt;
-        }
+        bluesteinOutputBuffer.resize(vectorSize);
+        bluesteinWorkBuffer.resize(bluesteinFFT->GetWorkSize());
       }
+      else
+      {
+        v1d.reset(new vnl_fft_1d<PixelType>(vectorSize));
+      }
+
+      fft1d::ForEachLineTile(
+        lambdaRegion,
+        direction,
+        fft1d::MaximumLineTileSize,
+        [&](const typename OutputImageType::IndexType & tileStart, SizeValueType numberOfLines) {
+          typename InputImageType::IndexType inputTileStart = tileStart;
+          inputTileStart[direction] = inputLineStart;
+          fft1d::GatherLineTile(
+            input, inputTileStart, direction, inputLineSize, numberOfLines, tileBuffer.data(), vectorSize);
+
+          for (SizeValueType line = 0; line < numberOfLines; ++line)
+          {
+            ComplexType * lineBuffer = tileBuffer.data() + line * vectorSize;
+
+            // do the transform
+            if (bluesteinFFT)
+            {
+              bluesteinFFT->Forward(
+                lineBuffer, inputLineSize, bluesteinOutputBuffer.data(), bluesteinWorkBuffer.data());
+              std::copy(bluesteinOutputBuffer.begin(), bluesteinOutputBuffer.end(), lineBuffer);
+            }
+            else
+            {
+              std::fill(lineBuffer + inputLineSize, lineBuffer + vectorSize, ComplexType(0));
+              vnl_vector_ref<ComplexType> lineVector(vectorSize, lineBuffer);
+              v1d->bwd_transform(lineVector);
+            }
+
+            // only the outputLineSize bins from firstBin on of each line are
+            // written
+            if ((line > 0 || firstBin > 0) && outputLineSize != vectorSize)
+            {
+              const ComplexType * bins = lineBuffer + firstBin;
+              std::copy(bins, bins + outputLineSize, tileBuffer.data() + line * outputLineSize);
+            }
+          }
+
+          fft1d::ScatterLineTile(output, tileStart, direction, outputLineSize, numberOfLines, tileBuffer.data());
+        });
     },
     this);
 }
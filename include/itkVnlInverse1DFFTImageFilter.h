@@ -29,6 +29,9 @@ namespace itk
  * \brief Perform the FFT along one dimension of an image using Vnl as a
  * backend.
  *
+ * vnl handles the line sizes with prime factors up to 5; the other sizes are
+ * transformed with Bluestein's algorithm, as in fft1d::NativeFFT.
+ *
  * \ingroup Ultrasound
  */
 template <typename TInputImage,
@@ -55,6 +58,12 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(VnlInverse1DFFTImageFilter, Inverse1DFFTImageFilter);
 
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const override
+  {
+    return 5;
+  }
+
 protected:
   void
   GenerateData() override;
@@ -20,15 +20,20 @@
 
 #include "itkVnlInverse1DFFTImageFilter.h"
 
+#include "itkFFT1DLineBatch.h"
 #include "itkInverse1DFFTImageFilter.hxx"
-#include "itkImageLinearConstIteratorWithIndex.h"
-#include "itkImageLinearIteratorWithIndex.h"
 #include "itkIndent.h"
 #include "itkMetaDataObject.h"
 #include "itkMacro.h"
+#include "itkNativeFFT1D.h"
+#include "itkVnlFFTCommon.h"
 #include "vnl/algo/vnl_fft_base.h"
 #include "vnl/algo/vnl_fft_1d.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 namespace itk
 {
 
@@ -42,58 +47,100 @@ VnlInverse1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
   const typename Superclass::InputImageType * input = this->GetInput();
   typename Superclass::OutputImageType *      output = this->GetOutput();
 
-  const typename Superclass::InputImageType::SizeType & inputSize = input->GetRequestedRegion().GetSize();
+  const typename Superclass::OutputImageType::SizeType & outputSize = output->GetRequestedRegion().GetSize();
 
   const unsigned int direction = this->GetDirection();
-  unsigned int       vectorSize = inputSize[direction];
+  unsigned int       vectorSize = outputSize[direction];
+
+  // only the non-negative frequencies of Hermitian input lines are read
+  const bool hermitianInput = this->m_HalfSpectrum || this->m_HermitianInput;
+
+  // vnl only handles sizes with prime factors up to 5, the other sizes go
+  // through Bluestein's algorithm
+  using OutputPixelType = typename TOutputImage::PixelType;
+  using BluesteinFFTType = fft1d::NativeFFT<OutputPixelType>;
+  std::unique_ptr<const BluesteinFFTType> bluesteinFFT;
+  if (!VnlFFTCommon::IsDimensionSizeLegal(vectorSize))
+  {
+    bluesteinFFT.reset(new BluesteinFFTType(vectorSize));
+  }
+
+  // the 1/N normalization is skipped in unnormalized mode
+  const OutputPixelType scale =
+    this->m_Normalize ? OutputPixelType(1) / static_cast<OutputPixelType>(vectorSize) : OutputPixelType(1);
 
   MultiThreaderBase * multiThreader = this->GetMultiThreader();
   multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
   multiThreader->template ParallelizeImageRegionRestrictDirection<TOutputImage::ImageDimension>(
     direction,
     output->GetRequestedRegion(),
-    [this, input, output, direction, vectorSize](const typename OutputImageType::RegionType & lambdaRegion) {
-      using InputIteratorType = ImageLinearConstIteratorWithIndex<InputImageType>;
-      using OutputIteratorType = ImageLinearIteratorWithIndex<OutputImageType>;
-      InputIteratorType  inputIt(input, lambdaRegion);
-      OutputIteratorType outputIt(output, lambdaRegion);
-
-      inputIt.SetDirection(direction);
-      outputIt.SetDirection(direction);
-
-      using OutputPixelType = typename TOutputImage::PixelType;
-      vnl_vector<std::complex<OutputPixelType>>                    inputBuffer(vectorSize);
-      typename vnl_vector<std::complex<OutputPixelType>>::iterator inputBufferIt = inputBuffer.begin();
-      // fft is done in-place
-      typename vnl_vector<std::complex<OutputPixelType>>::iterator outputBufferIt = inputBuffer.begin();
-      vnl_fft_1d<OutputPixelType>                                  v1d(vectorSize);
+    [this, input, output, direction, vectorSize, hermitianInput, scale, &bluesteinFFT](
+      const typename OutputImageType::RegionType & lambdaRegion) {
+      using ComplexType = std::complex<OutputPixelType>;
+      // the input lines only hold the non-negative frequencies in HalfSpectrum
+      // mode, and only those are read from Hermitian input lines
+      const SizeValueType  inputLineSize =
+        hermitianInput ? vectorSize / 2 + 1 : input->GetRequestedRegion().GetSize(direction);
+      const IndexValueType inputLineStart = input->GetRequestedRegion().GetIndex(direction);
 
-      // for every fft line
-      for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); outputIt.NextLine(), inputIt.NextLine())
+      // buffers of a tile of lines, see fft1d::ForEachLineTile
+      std::vector<ComplexType>     inputTileBuffer(fft1d::MaximumLineTileSize * inputLineSize);
+      std::vector<OutputPixelType> outputTileBuffer(fft1d::MaximumLineTileSize * vectorSize);
+      // fft is done in-place
+      vnl_vector<ComplexType>                      inputBuffer(vectorSize);
+      std::unique_ptr<vnl_fft_1d<OutputPixelType>> v1d;
+      std::vector<ComplexType>                     bluesteinOutputBuffer;
+      std::vector<ComplexType>                     bluesteinWorkBuffer;
+      if (bluesteinFFT)
       {
-        // copy the input line into our buffer
-        inputIt.GoToBeginOfLine();
-        inputBufferIt = inputBuffer.begin();
-        while (!inputIt.IsAtEndOfLine())
-        {
-          *inputBufferIt = inputIt.Get();
-          ++inputIt;
-          ++inputBufferIt;
-        }
-
-        // do the transform
-        v1d.fwd_transform(inputBuffer);
-
-        // copy the output from the buffer into our line
-        outputBufferIt = inputBuffer.begin();
-        outputIt.GoToBeginOfLine();
-        while (!outputIt.IsAtEndOfLine())
-        {
-          outputIt.Set((*outputBufferIt).real() / vectorSize);
-          ++outputIt;
-          ++outputBufferIt;
-        }
+        bluesteinOutputBuffer.resize(vectorSize);
+        bluesteinWorkBuffer.resize(bluesteinFFT->GetWorkSize());
       }
+      else
+      {
+        v1d.reset(new vnl_fft_1d<OutputPixelType>(vectorSize));
+      }
+
+      fft1d::ForEachLineTile(
+        lambdaRegion,
+        direction,
+        fft1d::MaximumLineTileSize,
+        [&](const typename OutputImageType::IndexType & tileStart, SizeValueType numberOfLines) {
+          typename InputImageType::IndexType inputTileStart = tileStart;
+          inputTileStart[direction] = inputLineStart;
+          fft1d::GatherLineTile(input, inputTileStart, direction, inputLineSize, numberOfLines, inputTileBuffer.data());
+
+          for (SizeValueType line = 0; line < numberOfLines; ++line)
+          {
+            const ComplexType * inputLine = inputTileBuffer.data() + line * inputLineSize;
+            std::copy(inputLine, inputLine + inputLineSize, inputBuffer.begin());
+            // fill in the negative frequencies from the Hermitian symmetry
+            for (SizeValueType k = inputLineSize; k < vectorSize; ++k)
+            {
+              inputBuffer[k] = std::conj(inputBuffer[vectorSize - k]);
+            }
+
+            // do the transform
+            if (bluesteinFFT)
+            {
+              bluesteinFFT->Backward(
+                inputBuffer.data_block(), bluesteinOutputBuffer.data(), bluesteinWorkBuffer.data());
+              std::copy(bluesteinOutputBuffer.begin(), bluesteinOutputBuffer.end(), inputBuffer.begin());
+            }
+            else
+            {
+              v1d->fwd_transform(inputBuffer);
+            }
+
+            OutputPixelType * outputLine = outputTileBuffer.data() + line * vectorSize;
+            for (SizeValueType k = 0; k < vectorSize; ++k)
+            {
+              outputLine[k] = inputBuffer[k].real() * scale;
+            }
+          }
+
+          fft1d::ScatterLineTile(output, tileStart, direction, vectorSize, numberOfLines, outputTileBuffer.data());
+        });
     },
     this);
 }
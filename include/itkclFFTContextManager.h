@@ -0,0 +1,127 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkclFFTContextManager_h) && defined(ITKUltrasound_USE_clFFT)
+#  define itkclFFTContextManager_h
+#  include "UltrasoundExport.h"
+
+#  define __CL_ENABLE_EXCEPTIONS
+#  include "CL/cl.hpp"
+#  include "clFFT.h"
+
+#  include <mutex>
+#  include <string>
+#  include <vector>
+
+namespace itk
+{
+/** \class clFFTContextManager
+ * \brief Process-wide OpenCL device and context shared by the clFFT based 1D
+ * FFT filters.
+ *
+ * The context of the selected device is created on first use and shared by
+ * all the filters constructed afterwards, each with its own command queues,
+ * so that the work of several filters can be in flight at once. The device
+ * is chosen, in order of preference:
+ * - with SelectDeviceByType(), SelectDeviceByName() or SelectFastestDevice();
+ * - from the ITKUltrasound_OPENCL_DEVICE environment variable, read on first
+ *   use, set to "gpu", "cpu", "accelerator", "fastest", or a part of the name
+ *   of a device;
+ * - as the first GPU, then the first accelerator, then the first device of
+ *   any type.
+ * A selection matching no device falls back to the last rule.
+ *
+ * Selecting a device only affects the filters constructed afterwards. The
+ * methods of this class are thread safe.
+ *
+ * \ingroup Ultrasound
+ */
+class Ultrasound_EXPORT clFFTContextManager
+{
+public:
+  static clFFTContextManager &
+  GetInstance();
+
+  /** Use the first device of this type, e.g. CL_DEVICE_TYPE_GPU. */
+  void
+  SelectDeviceByType(cl_device_type type);
+
+  /** Use the first device whose name contains this string, not case
+   * sensitive. */
+  void
+  SelectDeviceByName(const std::string & name);
+
+  /** Use the device that runs a batch of transforms, transfers included, in
+   * the shortest time. The devices are benchmarked once. */
+  void
+  SelectFastestDevice();
+
+  /** Forget the selection: the next use reads the environment variable
+   * again. */
+  void
+  ResetDeviceSelection();
+
+  /** Context of the selected device. Throws an ExceptionObject when there is
+   * no OpenCL device. */
+  cl::Context
+  GetContext();
+
+  cl::Device
+  GetDevice();
+
+  /** A new command queue on the selected device. */
+  cl::CommandQueue
+  CreateQueue();
+
+  /** All the OpenCL devices of all the platforms. */
+  static std::vector<cl::Device>
+  GetAllDevices();
+
+private:
+  enum SelectionType
+  {
+    DEFAULT_SELECTION = 0,
+    TYPE_SELECTION,
+    NAME_SELECTION,
+    FASTEST_SELECTION
+  };
+
+  clFFTContextManager() = default;
+
+  /** Create the context of the selected device when there is none. Called with
+   * m_Mutex held. */
+  void
+  MakeContext();
+
+  void
+  SetSelection(SelectionType selection, cl_device_type type, const std::string & name);
+
+  static double
+  TimeDevice(const cl::Device & device);
+
+  std::mutex     m_Mutex;
+  bool           m_SelectionInitialized = false;
+  SelectionType  m_Selection = DEFAULT_SELECTION;
+  cl_device_type m_SelectedType = CL_DEVICE_TYPE_DEFAULT;
+  std::string    m_SelectedName;
+  bool           m_ContextCreated = false;
+  cl::Device     m_Device;
+  cl::Context    m_Context;
+};
+
+} // namespace itk
+#endif // itkclFFTContextManager_h
@@ -0,0 +1,38 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkBModeImageFilter.h"
+
+namespace itk
+{
+/** Print enum values */
+std::ostream &
+operator<<(std::ostream & out, const BModeImageFilterEnums::EnvelopeMethod value)
+{
+  return out << [value] {
+    switch (value)
+    {
+      case BModeImageFilterEnums::EnvelopeMethod::FFT:
+        return "itk::BModeImageFilterEnums::EnvelopeMethod::FFT";
+      case BModeImageFilterEnums::EnvelopeMethod::HilbertFIR:
+        return "itk::BModeImageFilterEnums::EnvelopeMethod::HilbertFIR";
+      default:
+        return "INVALID VALUE FOR itk::BModeImageFilterEnums::EnvelopeMethod";
+    }
+  }();
+}
+} // end namespace itk
@@ -0,0 +1,307 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkclFFTContextManager.h"
+#include "itkclFFTInitializer.h"
+#include "itkMacro.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <complex>
+#include <cstdlib>
+#include <limits>
+
+namespace itk
+{
+
+namespace
+{
+std::string
+ToLower(std::string text)
+{
+  std::transform(
+    text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return text;
+}
+} // namespace
+
+clFFTContextManager &
+clFFTContextManager::GetInstance()
+{
+  // clFFT is set up before the manager, so that it is torn down after it
+  clFFFInitialization();
+  static clFFTContextManager manager;
+  return manager;
+}
+
+void
+clFFTContextManager::SelectDeviceByType(cl_device_type type)
+{
+  this->SetSelection(TYPE_SELECTION, type, "");
+}
+
+void
+clFFTContextManager::SelectDeviceByName(const std::string & name)
+{
+  this->SetSelection(NAME_SELECTION, CL_DEVICE_TYPE_DEFAULT, name);
+}
+
+void
+clFFTContextManager::SelectFastestDevice()
+{
+  this->SetSelection(FASTEST_SELECTION, CL_DEVICE_TYPE_DEFAULT, "");
+}
+
+void
+clFFTContextManager::ResetDeviceSelection()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_SelectionInitialized = false;
+  m_ContextCreated = false;
+}
+
+void
+clFFTContextManager::SetSelection(SelectionType selection, cl_device_type type, const std::string & name)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Selection = selection;
+  m_SelectedType = type;
+  m_SelectedName = name;
+  m_SelectionInitialized = true;
+  m_ContextCreated = false;
+}
+
+cl::Context
+clFFTContextManager::GetContext()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  this->MakeContext();
+  return m_Context;
+}
+
+cl::Device
+clFFTContextManager::GetDevice()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  this->MakeContext();
+  return m_Device;
+}
+
+cl::CommandQueue
+clFFTContextManager::CreateQueue()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  this->MakeContext();
+  try
+  {
+    return cl::CommandQueue(m_Context, m_Device);
+  }
+  catch (const cl::Error & e)
+  {
+    itkGenericExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+std::vector<cl::Device>
+clFFTContextManager::GetAllDevices()
+{
+  std::vector<cl::Device> allDevices;
+  try
+  {
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    for (const cl::Platform & platform : platforms)
+    {
+      std::vector<cl::Device> devices;
+      try
+      {
+        platform.getDevices(CL_DEVICE_TYPE_ALL, &devices);
+      }
+      catch (const cl::Error &)
+      {
+        // a platform without devices
+        continue;
+      }
+      allDevices.insert(allDevices.end(), devices.begin(), devices.end());
+    }
+  }
+  catch (const cl::Error &)
+  {
+    // no platform
+  }
+  return allDevices;
+}
+
+void
+clFFTContextManager::MakeContext()
+{
+  if (m_ContextCreated)
+  {
+    return;
+  }
+  if (!m_SelectionInitialized)
+  {
+    m_Selection = DEFAULT_SELECTION;
+    const char * selection = std::getenv("ITKUltrasound_OPENCL_DEVICE");
+    if (selection != nullptr)
+    {
+      const std::string name = ToLower(selection);
+      if (name == "gpu" || name == "cpu" || name == "accelerator")
+      {
+        m_Selection = TYPE_SELECTION;
+        m_SelectedType = name == "gpu" ? CL_DEVICE_TYPE_GPU
+                                       : (name == "cpu" ? CL_DEVICE_TYPE_CPU : CL_DEVICE_TYPE_ACCELERATOR);
+      }
+      else if (name == "fastest")
+      {
+        m_Selection = FASTEST_SELECTION;
+      }
+      else if (!name.empty() && name != "default")
+      {
+        m_Selection = NAME_SELECTION;
+        m_SelectedName = name;
+      }
+    }
+    m_SelectionInitialized = true;
+  }
+
+  const std::vector<cl::Device> devices = GetAllDevices();
+  if (devices.empty())
+  {
+    itkGenericExceptionMacro("No OpenCL devices found.");
+  }
+  const auto deviceType = [](const cl::Device & device) { return device.getInfo<CL_DEVICE_TYPE>(); };
+
+  auto selected = devices.end();
+  switch (m_Selection)
+  {
+    case TYPE_SELECTION:
+      selected = std::find_if(devices.begin(), devices.end(), [&](const cl::Device & device) {
+        return (deviceType(device) & m_SelectedType) != 0;
+      });
+      break;
+    case NAME_SELECTION:
+    {
+      const std::string name = ToLower(m_SelectedName);
+      selected = std::find_if(devices.begin(), devices.end(), [&](const cl::Device & device) {
+        return ToLower(device.getInfo<CL_DEVICE_NAME>()).find(name) != std::string::npos;
+      });
+      break;
+    }
+    case FASTEST_SELECTION:
+    {
+      double fastestTime = std::numeric_limits<double>::max();
+      for (auto device = devices.begin(); device != devices.end(); ++device)
+      {
+        const double time = TimeDevice(*device);
+        if (time >= 0.0 && time < fastestTime)
+        {
+          selected = device;
+          fastestTime = time;
+        }
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  if (selected == devices.end())
+  {
+    for (cl_device_type type : { cl_device_type{ CL_DEVICE_TYPE_GPU }, cl_device_type{ CL_DEVICE_TYPE_ACCELERATOR } })
+    {
+      selected = std::find_if(devices.begin(), devices.end(), [&](const cl::Device & device) {
+        return (deviceType(device) & type) != 0;
+      });
+      if (selected != devices.end())
+      {
+        break;
+      }
+    }
+  }
+  if (selected == devices.end())
+  {
+    selected = devices.begin();
+  }
+
+  try
+  {
+    m_Device = *selected;
+    m_Context = cl::Context(std::vector<cl::Device>(1, m_Device));
+  }
+  catch (const cl::Error & e)
+  {
+    itkGenericExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+  m_ContextCreated = true;
+}
+
+double
+clFFTContextManager::TimeDevice(const cl::Device & device)
+{
+  using ClockType = std::chrono::steady_clock;
+  const size_t       lineSize = 1024;
+  const size_t       numberOfLines = 256;
+  clfftPlanHandle    plan = 0;
+  double             shortest = std::numeric_limits<double>::max();
+  std::vector<float> data(2 * lineSize * numberOfLines, 1.0f);
+  const size_t       bytes = data.size() * sizeof(float);
+  try
+  {
+    cl::Context      context(std::vector<cl::Device>(1, device));
+    cl::CommandQueue queue(context, device);
+    cl::Buffer       buffer(context, CL_MEM_READ_WRITE, bytes);
+    const size_t     n[3] = { lineSize, 1, 1 };
+    if (clfftCreateDefaultPlan(&plan, context(), CLFFT_1D, n) != CLFFT_SUCCESS)
+    {
+      return -1.0;
+    }
+    clfftSetResultLocation(plan, CLFFT_INPLACE);
+    clfftSetPlanBatchSize(plan, numberOfLines);
+    cl_command_queue queueHandle = queue();
+    cl_mem           bufferHandle = buffer();
+    if (clfftBakePlan(plan, 1, &queueHandle, nullptr, nullptr) != CLFFT_SUCCESS)
+    {
+      clfftDestroyPlan(&plan);
+      return -1.0;
+    }
+    // the first run compiles the kernels
+    for (unsigned int run = 0; run < 4; ++run)
+    {
+      const ClockType::time_point start = ClockType::now();
+      queue.enqueueWriteBuffer(buffer, CL_FALSE, 0, bytes, data.data());
+      clfftEnqueueTransform(plan, CLFFT_FORWARD, 1, &queueHandle, 0, nullptr, nullptr, &bufferHandle, nullptr, nullptr);
+      queue.enqueueReadBuffer(buffer, CL_TRUE, 0, bytes, data.data());
+      const std::chrono::duration<double> elapsed = ClockType::now() - start;
+      if (run > 0)
+      {
+        shortest = std::min(shortest, elapsed.count());
+      }
+    }
+  }
+  catch (const cl::Error &)
+  {
+    shortest = -1.0;
+  }
+  if (plan)
+  {
+    clfftDestroyPlan(&plan);
+  }
+  return shortest;
+}
+
+} // namespace itk
@@ -33,7 +33,7 @@ itkAnalyticSignalImageFilterTest(int argc, char * argv[])
   if (argc < 3)
   {
     std::cerr << "Usage: " << argv[0];
-    std::cerr << " inputImage outputImagePrefix";
+    std::cerr << " inputImage outputImagePrefix [singlePass]";
     std::cerr << std::endl;
     return EXIT_FAILURE;
   }
@@ -67,6 +67,10 @@ itkAnalyticSignalImageFilterTest(int argc, char * argv[])
   pad->SetConstant(0.);
   analytic->SetInput(pad->GetOutput());
   analytic->SetDirection(1);
+  if (argc > 3)
+  {
+    analytic->SetSinglePass(std::stoi(argv[3]) != 0);
+  }
   realFilter->SetInput(analytic->GetOutput());
   imaginaryFilter->SetInput(analytic->GetOutput());
 
@@ -18,12 +18,19 @@
 // Test the performance of the BModeImageFilter
 //
 
+#include "itkImageDuplicator.h"
 #include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
 #include "itkIntensityWindowingImageFilter.h"
 #include "itkTimeProbe.h"
 #include "itkImageFileWriter.h"
 
 #include "itkBModeImageFilter.h"
+#include "itkFFT1DScratchArena.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
 
 int
 itkBModeImageFilterTestTiming(int argc, char * argv[])
@@ -31,12 +38,19 @@ itkBModeImageFilterTestTiming(int argc, char * argv[])
   if (argc < 3)
   {
     std::cerr << "Usage: " << argv[0];
-    std::cerr << " inputImage outputImage";
+    std::cerr << " inputImage outputImage [runs]";
     std::cerr << std::endl;
     return EXIT_FAILURE;
   }
   const char * inputImageFileName = argv[1];
   const char * outputImageFileName = argv[2];
+  // the checks of the engines only need a couple of frames; more runs give
+  // steadier frame rates
+  int runs = 100;
+  if (argc > 3)
+  {
+    runs = std::stoi(argv[3]);
+  }
 
   using PixelType = float;
   const unsigned int Dimension = 3;
@@ -64,24 +78,104 @@ itkBModeImageFilterTestTiming(int argc, char * argv[])
   using WindowingType = itk::IntensityWindowingImageFilter<ImageType, ImageType>;
   WindowingType::Pointer window = WindowingType::New();
   window->SetInput(bMode->GetOutput());
+  // running in place, the window filter would take the B-mode output buffer
+  // away at each update
+  window->InPlaceOff();
 
-  itk::TimeProbe clock;
-
-  const int runs = 1000;
-  for (int i = 0; i < runs; i++)
+  // the frame stream and single pass engines first, then the reference
+  // pipeline, whose output is written
+  enum
   {
-    bMode->Modified();
-    clock.Start();
-    window->Update();
-    clock.Stop();
-  }
+    FRAME_STREAM = 0,
+    SINGLE_PASS,
+    PIPELINE
+  };
+  const char * const modeNames[] = { "Frame stream", "Single pass", "Pipeline" };
+  ImageType::Pointer engineOutputs[PIPELINE];
+  for (int mode : { FRAME_STREAM, SINGLE_PASS, PIPELINE })
+  {
+    bMode->SetFrameStream(mode == FRAME_STREAM);
+    bMode->SetSinglePass(mode == SINGLE_PASS);
+    if (mode == FRAME_STREAM)
+    {
+      // the first frame makes the state of the stream
+      window->Update();
+    }
+    const itk::SizeValueType                    numberOfAllocations = bMode->GetNumberOfAllocations();
+    const ImageType::PixelContainerConstPointer outputContainer = bMode->GetOutput()->GetPixelContainer();
+    const PixelType *                           outputBuffer = bMode->GetOutput()->GetBufferPointer();
+    itk::TimeProbe                              clock;
+    // allocations of the line buffers, whichever filter code path makes them
+    const itk::SizeValueType numberOfScratchAllocations = itk::fft1d::ScratchArena::GetNumberOfAllocations();
+
+    for (int i = 0; i < runs; i++)
+    {
+      bMode->Modified();
+      clock.Start();
+      window->Update();
+      clock.Stop();
+    }
 
-  ImageType::SizeType size = bMode->GetOutput()->GetLargestPossibleRegion().GetSize();
+    ImageType::SizeType size = bMode->GetOutput()->GetLargestPossibleRegion().GetSize();
 
-  double frame_rate = static_cast<double>(size[2]) / clock.GetMean();
+    double frame_rate = static_cast<double>(size[2]) / clock.GetMean();
 
-  std::cout << "Frame rate achieved over " << clock.GetNumberOfStarts() << " runs was " << frame_rate << " fp"
-            << clock.GetUnit() << "." << std::endl;
+    std::cout << modeNames[mode] << ": Frame rate achieved over " << clock.GetNumberOfStarts() << " runs was "
+              << frame_rate << " fp" << clock.GetUnit() << "." << std::endl;
+
+    if (mode == FRAME_STREAM)
+    {
+      if (bMode->GetNumberOfAllocations() != numberOfAllocations)
+      {
+        std::cerr << "The frame stream made " << bMode->GetNumberOfAllocations() - numberOfAllocations
+                  << " allocations after its first frame" << std::endl;
+        return EXIT_FAILURE;
+      }
+      // the count of the filter is kept by its own code paths; the scratch
+      // arena counts the line buffers it actually allocates
+      if (itk::fft1d::ScratchArena::GetNumberOfAllocations() != numberOfScratchAllocations)
+      {
+        std::cerr << "The frame stream made "
+                  << itk::fft1d::ScratchArena::GetNumberOfAllocations() - numberOfScratchAllocations
+                  << " scratch allocations after its first frame" << std::endl;
+        return EXIT_FAILURE;
+      }
+      // the count relies on the output keeping its pixel container
+      if (bMode->GetOutput()->GetPixelContainer() != outputContainer.GetPointer() ||
+          bMode->GetOutput()->GetBufferPointer() != outputBuffer)
+      {
+        std::cerr << "The frame stream did not keep its output buffer" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    if (mode != PIPELINE)
+    {
+      using DuplicatorType = itk::ImageDuplicator<ImageType>;
+      DuplicatorType::Pointer duplicator = DuplicatorType::New();
+      duplicator->SetInputImage(bMode->GetOutput());
+      duplicator->Update();
+      engineOutputs[mode] = duplicator->GetOutput();
+    }
+  }
+
+  // all the engines compute the same envelope
+  for (int mode : { FRAME_STREAM, SINGLE_PASS })
+  {
+    const ImageType *                        engineOutput = engineOutputs[mode];
+    itk::ImageRegionConstIterator<ImageType> engineIt(engineOutput, engineOutput->GetBufferedRegion());
+    itk::ImageRegionConstIterator<ImageType> pipelineIt(bMode->GetOutput(), engineOutput->GetBufferedRegion());
+    double                                   maximumDifference = 0.0;
+    for (; !engineIt.IsAtEnd(); ++engineIt, ++pipelineIt)
+    {
+      maximumDifference = std::max(maximumDifference, std::abs(double{ engineIt.Get() } - pipelineIt.Get()));
+    }
+    if (maximumDifference > 1e-3)
+    {
+      std::cerr << "The " << modeNames[mode] << " and pipeline outputs differ by " << maximumDifference << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
 
   using WriterType = itk::ImageFileWriter<ImageType>;
   WriterType::Pointer writer = WriterType::New();
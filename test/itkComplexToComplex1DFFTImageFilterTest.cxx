@@ -25,6 +25,7 @@
 #include "itkImageFileWriter.h"
 
 #include "itkComplexToComplex1DFFTImageFilter.h"
+#include "itkNativeComplexToComplex1DFFTImageFilter.h"
 #include "itkVnlComplexToComplex1DFFTImageFilter.h"
 #if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
 #  include "itkFFTWComplexToComplex1DFFTImageFilter.h"
@@ -35,7 +36,7 @@
 
 template <typename FFTType>
 int
-doTest(const char * inputImagePrefix, const char * outputImage)
+doTest(const char * inputImagePrefix, const char * outputImage, bool inPlace)
 {
   using ComplexImageType = typename FFTType::InputImageType;
   using ImageType = itk::Image<typename itk::NumericTraits<typename ComplexImageType::PixelType>::ValueType,
@@ -58,6 +59,7 @@ doTest(const char * inputImagePrefix, const char * outputImage)
   joinFilter->SetInput1(readerReal->GetOutput());
   joinFilter->SetInput2(readerImag->GetOutput());
   fft->SetTransformDirection(FFTType::INVERSE);
+  fft->SetInPlace(inPlace);
   fft->SetInput(joinFilter->GetOutput());
   toReal->SetInput(fft->GetOutput());
   writer->SetInput(toReal->GetOutput());
@@ -85,12 +87,13 @@ itkComplexToComplex1DFFTImageFilterTest(int argc, char * argv[])
   if (argc < 3)
   {
     std::cerr << "Usage: " << argv[0];
-    std::cerr << " inputImagePrefix outputImage [backend]\n";
+    std::cerr << " inputImagePrefix outputImage [backend] [inPlace]\n";
     std::cerr << "backend implementation options:\n";
     std::cerr << "  0 default\n";
     std::cerr << "  1 VNL\n";
     std::cerr << "  2 FFTW\n";
     std::cerr << "  3 OpenCL via clFFT\n";
+    std::cerr << "  4 Native\n";
     std::cerr << std::flush;
     return EXIT_FAILURE;
   }
@@ -106,31 +109,41 @@ itkComplexToComplex1DFFTImageFilterTest(int argc, char * argv[])
   {
     backend = std::stoi(argv[3]);
   }
+  bool inPlace = false;
+  if (argc > 4)
+  {
+    inPlace = std::stoi(argv[4]) != 0;
+  }
 
   if (backend == 0)
   {
     using FFTInverseType = itk::ComplexToComplex1DFFTImageFilter<ComplexImageType, ComplexImageType>;
-    return doTest<FFTInverseType>(argv[1], argv[2]);
+    return doTest<FFTInverseType>(argv[1], argv[2], inPlace);
   }
   else if (backend == 1)
   {
     using FFTInverseType = itk::VnlComplexToComplex1DFFTImageFilter<ComplexImageType, ComplexImageType>;
-    return doTest<FFTInverseType>(argv[1], argv[2]);
+    return doTest<FFTInverseType>(argv[1], argv[2], inPlace);
   }
   else if (backend == 2)
   {
 #if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
     using FFTInverseType = itk::FFTWComplexToComplex1DFFTImageFilter<ComplexImageType, ComplexImageType>;
-    return doTest<FFTInverseType>(argv[1], argv[2]);
+    return doTest<FFTInverseType>(argv[1], argv[2], inPlace);
 #endif
   }
   else if (backend == 3)
   {
 #if defined(ITKUltrasound_USE_clFFT)
     using FFTInverseType = itk::OpenCLComplexToComplex1DFFTImageFilter<ComplexImageType, ComplexImageType>;
-    return doTest<FFTInverseType>(argv[1], argv[2]);
+    return doTest<FFTInverseType>(argv[1], argv[2], inPlace);
 #endif
   }
+  else if (backend == 4)
+  {
+    using FFTInverseType = itk::NativeComplexToComplex1DFFTImageFilter<ComplexImageType, ComplexImageType>;
+    return doTest<FFTInverseType>(argv[1], argv[2], inPlace);
+  }
 
   std::cerr << "Backend " << backend << " (" << argv[3] << ") not implemented" << std::endl;
   return EXIT_FAILURE;
@@ -18,13 +18,18 @@
 
 #include <complex>
 #include <string>
+#include <vector>
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
+#include "itkFFT1DBackendRegistry.h"
+#include "itkFFT1DScratchArena.h"
 #include "itkForward1DFFTImageFilter.h"
 #include "itkInverse1DFFTImageFilter.h"
 
+#include "itkNativeForward1DFFTImageFilter.h"
+#include "itkNativeInverse1DFFTImageFilter.h"
 #include "itkVnlForward1DFFTImageFilter.h"
 #include "itkVnlInverse1DFFTImageFilter.h"
 #if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
@@ -38,10 +43,12 @@
 
 template <typename FFTForwardType, typename FFTInverseType>
 int
-doTest(const char * inputImage, const char * outputImage)
+doTest(const char *                     inputImage,
+       const char *                     outputImage,
+       const unsigned int               direction,
+       typename FFTForwardType::Pointer fftForward = FFTForwardType::New(),
+       typename FFTInverseType::Pointer fftInverse = FFTInverseType::New())
 {
-  const unsigned int direction = 1;
-
   using ImageType = typename FFTForwardType::InputImageType;
   using ComplexImageType = typename FFTInverseType::InputImageType;
 
@@ -49,11 +56,9 @@ doTest(const char * inputImage, const char * outputImage)
   typename ReaderType::Pointer reader = ReaderType::New();
   reader->SetFileName(inputImage);
 
-  typename FFTForwardType::Pointer fftForward = FFTForwardType::New();
   fftForward->SetInput(reader->GetOutput());
   fftForward->SetDirection(direction);
 
-  typename FFTInverseType::Pointer fftInverse = FFTInverseType::New();
   fftInverse->SetInput(fftForward->GetOutput());
   fftInverse->SetDirection(direction);
 
@@ -85,12 +90,16 @@ itkFFT1DImageFilterTest(int argc, char * argv[])
   if (argc < 3)
   {
     std::cerr << "Usage: " << argv[0];
-    std::cerr << " inputImage outputImage [backend]\n";
+    std::cerr << " inputImage outputImage [backend] [direction] [batchSize] [numberOfPlanThreads]\n";
     std::cerr << "backend implementation options:\n";
     std::cerr << "  0 default\n";
     std::cerr << "  1 VNL\n";
     std::cerr << "  2 FFTW\n";
     std::cerr << "  3 OpenCL via clFFT\n";
+    std::cerr << "  4 Native\n";
+    std::cerr << "  5 auto-tuned by the backend registry\n";
+    std::cerr << "batchSize and numberOfPlanThreads are only used by the FFTW backend,\n";
+    std::cerr << "batchSize is the number of lines per chunk of the OpenCL backend\n";
     std::cerr << std::flush;
     return EXIT_FAILURE;
   }
@@ -106,25 +115,80 @@ itkFFT1DImageFilterTest(int argc, char * argv[])
   {
     backend = std::stoi(argv[3]);
   }
+  unsigned int direction = 1;
+  if (argc > 4)
+  {
+    direction = std::stoi(argv[4]);
+  }
 
   if (backend == 0)
   {
     using FFTForwardType = itk::Forward1DFFTImageFilter<ImageType, ComplexImageType>;
     using FFTInverseType = itk::Inverse1DFFTImageFilter<ComplexImageType, ImageType>;
-    return doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2]);
+    return doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2], direction);
   }
   else if (backend == 1)
   {
     using FFTForwardType = itk::VnlForward1DFFTImageFilter<ImageType, ComplexImageType>;
     using FFTInverseType = itk::VnlInverse1DFFTImageFilter<ComplexImageType, ImageType>;
-    return doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2]);
+    return doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2], direction);
   }
   else if (backend == 2)
   {
 #if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
     using FFTForwardType = itk::FFTWForward1DFFTImageFilter<ImageType, ComplexImageType>;
     using FFTInverseType = itk::FFTWInverse1DFFTImageFilter<ComplexImageType, ImageType>;
-    return doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2]);
+    FFTForwardType::Pointer fftForward = FFTForwardType::New();
+    FFTInverseType::Pointer fftInverse = FFTInverseType::New();
+    if (argc > 5)
+    {
+      fftForward->SetBatchSize(std::stoi(argv[5]));
+      fftInverse->SetBatchSize(std::stoi(argv[5]));
+    }
+    if (argc > 6)
+    {
+      fftForward->SetNumberOfPlanThreads(std::stoi(argv[6]));
+      fftInverse->SetNumberOfPlanThreads(std::stoi(argv[6]));
+      // run the threads of FFTW on the ITK pool when the callback is available
+      std::cout << "FFTW threads on the ITK thread pool: " << itk::fftw::SetUseITKThreadPool(true) << std::endl;
+    }
+    if (doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2], direction, fftForward, fftInverse) == EXIT_FAILURE)
+    {
+      return EXIT_FAILURE;
+    }
+
+    // a second pipeline transforming lines of the same size gets its plans
+    // from the shared plan cache
+    using PlanCacheType = FFTForwardType::PlanCacheType;
+    const itk::SizeValueType hits = PlanCacheType::GetHits();
+    const itk::SizeValueType misses = PlanCacheType::GetMisses();
+    std::cout << "Plan cache: " << PlanCacheType::GetNumberOfPlans() << " plans, " << hits << " hits, " << misses
+              << " misses" << std::endl;
+    if (misses == 0 || PlanCacheType::GetNumberOfPlans() > PlanCacheType::GetMaximumNumberOfPlans())
+    {
+      std::cerr << "Unexpected plan cache state" << std::endl;
+      return EXIT_FAILURE;
+    }
+    FFTForwardType::Pointer otherFFTForward = FFTForwardType::New();
+    FFTInverseType::Pointer otherFFTInverse = FFTInverseType::New();
+    otherFFTForward->SetBatchSize(fftForward->GetBatchSize());
+    otherFFTInverse->SetBatchSize(fftInverse->GetBatchSize());
+    otherFFTForward->SetNumberOfPlanThreads(fftForward->GetNumberOfPlanThreads());
+    otherFFTInverse->SetNumberOfPlanThreads(fftInverse->GetNumberOfPlanThreads());
+    // many more work units than threads share the pooled line buffers
+    otherFFTForward->SetNumberOfWorkUnits(64);
+    otherFFTInverse->SetNumberOfWorkUnits(64);
+    if (doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2], direction, otherFFTForward, otherFFTInverse) ==
+        EXIT_FAILURE)
+    {
+      return EXIT_FAILURE;
+    }
+    if (PlanCacheType::GetHits() <= hits)
+    {
+      std::cerr << "The plans were not reused from the plan cache" << std::endl;
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
 #endif
   }
   else if (backend == 3)
@@ -132,9 +196,135 @@ itkFFT1DImageFilterTest(int argc, char * argv[])
 #if defined(ITKUltrasound_USE_clFFT)
     using FFTForwardType = itk::OpenCLForward1DFFTImageFilter<ImageType, ComplexImageType>;
     using FFTInverseType = itk::OpenCLInverse1DFFTImageFilter<ComplexImageType, ImageType>;
-    return doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2]);
+    // both filters run on the shared context of the selected device
+    std::cout << "OpenCL device: " << itk::clFFTContextManager::GetInstance().GetDevice().getInfo<CL_DEVICE_NAME>()
+              << std::endl;
+    FFTForwardType::Pointer fftForward = FFTForwardType::New();
+    FFTInverseType::Pointer fftInverse = FFTInverseType::New();
+    if (argc > 5)
+    {
+      fftForward->SetNumberOfLinesPerChunk(std::stoi(argv[5]));
+      fftInverse->SetNumberOfLinesPerChunk(std::stoi(argv[5]));
+    }
+    if (doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2], direction, fftForward, fftInverse) == EXIT_FAILURE)
+    {
+      return EXIT_FAILURE;
+    }
+    // the second update reuses the plans and device buffers
+    return doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2], direction, fftForward, fftInverse);
 #endif
   }
+  else if (backend == 4)
+  {
+    using FFTForwardType = itk::NativeForward1DFFTImageFilter<ImageType, ComplexImageType>;
+    using FFTInverseType = itk::NativeInverse1DFFTImageFilter<ComplexImageType, ImageType>;
+    if (doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2], direction) == EXIT_FAILURE)
+    {
+      return EXIT_FAILURE;
+    }
+
+    // once the line buffers have been allocated, the next updates take them
+    // from the free lists of the scratch arena; a single work unit runs on
+    // the calling thread, so that it finds them in the free list of the thread
+    using ScratchArenaType = itk::fft1d::ScratchArena;
+    FFTForwardType::Pointer fftForward = FFTForwardType::New();
+    FFTInverseType::Pointer fftInverse = FFTInverseType::New();
+    fftForward->SetNumberOfWorkUnits(1);
+    fftInverse->SetNumberOfWorkUnits(1);
+    if (doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2], direction, fftForward, fftInverse) == EXIT_FAILURE)
+    {
+      return EXIT_FAILURE;
+    }
+    const itk::SizeValueType allocations = ScratchArenaType::GetNumberOfAllocations();
+    const itk::SizeValueType reuses = ScratchArenaType::GetNumberOfReuses();
+    if (doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2], direction, fftForward, fftInverse) == EXIT_FAILURE)
+    {
+      return EXIT_FAILURE;
+    }
+    std::cout << "Scratch arena: " << ScratchArenaType::GetNumberOfAllocations() << " allocations, "
+              << ScratchArenaType::GetNumberOfReuses() << " reuses, " << ScratchArenaType::GetNumberOfAllocatedBytes()
+              << " bytes" << std::endl;
+    if (ScratchArenaType::GetNumberOfAllocations() != allocations || ScratchArenaType::GetNumberOfReuses() <= reuses)
+    {
+      std::cerr << "The line buffers were allocated again" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // the free lists keep a bounded number of blocks of a size, and free the
+    // blocks released beyond
+    ScratchArenaType::FreeCachedBlocks();
+    const itk::SizeValueType keptBlocks =
+      ScratchArenaType::MaximumNumberOfCachedBlocks + ScratchArenaType::MaximumNumberOfSharedBlocks;
+    const itk::SizeValueType bytes = ScratchArenaType::GetNumberOfAllocatedBytes();
+    itk::SizeValueType       capacity = 0;
+    std::vector<void *>      blocks;
+    for (itk::SizeValueType block = 0; block < keptBlocks + 4; ++block)
+    {
+      blocks.push_back(ScratchArenaType::Acquire(1024, capacity));
+    }
+    for (void * block : blocks)
+    {
+      ScratchArenaType::Release(block, capacity);
+    }
+    if (ScratchArenaType::GetNumberOfAllocatedBytes() - bytes != keptBlocks * capacity)
+    {
+      std::cerr << "The free lists kept " << ScratchArenaType::GetNumberOfAllocatedBytes() - bytes << " bytes instead of "
+                << keptBlocks * capacity << std::endl;
+      return EXIT_FAILURE;
+    }
+    ScratchArenaType::FreeCachedBlocks();
+    return EXIT_SUCCESS;
+  }
+  else if (backend == 5)
+  {
+    using FFTForwardType = itk::Forward1DFFTImageFilter<ImageType, ComplexImageType>;
+    using FFTInverseType = itk::Inverse1DFFTImageFilter<ComplexImageType, ImageType>;
+    using RegistryType = itk::fft1d::BackendRegistry;
+
+    // the registry backend overrides the compile time default
+    RegistryType::SetBackend(RegistryType::VNL);
+    FFTForwardType::Pointer vnlForward = FFTForwardType::New();
+    if (std::string(vnlForward->GetNameOfClass()) != "VnlForward1DFFTImageFilter")
+    {
+      std::cerr << "Expected the vnl backend, got " << vnlForward->GetNameOfClass() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    using ReaderType = itk::ImageFileReader<ImageType>;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(argv[1]);
+    reader->UpdateOutputInformation();
+    const ImageType::RegionType & region = reader->GetOutput()->GetLargestPossibleRegion();
+    const itk::SizeValueType      lineSize = region.GetSize(direction);
+    const itk::SizeValueType      numberOfLines = region.GetNumberOfPixels() / lineSize;
+
+    RegistryType::SetBackend(RegistryType::AUTO_TUNE);
+    RegistryType::ClearTunedBackends();
+    FFTForwardType::Pointer fftForward = FFTForwardType::New(lineSize, numberOfLines, direction);
+    FFTInverseType::Pointer fftInverse = FFTInverseType::New(lineSize, numberOfLines, direction);
+    std::cout << "Auto-tuned backends: " << fftForward->GetNameOfClass() << ", " << fftInverse->GetNameOfClass()
+              << std::endl;
+    // the second filter of a kind and size reuses the cached choice
+    FFTForwardType::Pointer otherFFTForward = FFTForwardType::New(lineSize, numberOfLines, direction);
+    if (RegistryType::GetNumberOfTunedSizes() != 2 ||
+        std::string(otherFFTForward->GetNameOfClass()) != fftForward->GetNameOfClass())
+    {
+      std::cerr << "Unexpected auto-tuning state" << std::endl;
+      return EXIT_FAILURE;
+    }
+    // lines of the same size along another direction are strided differently
+    // in memory, and tuned on their own
+    const unsigned int      otherDirection = (direction + 1) % Dimension;
+    FFTForwardType::Pointer otherDirectionFFTForward = FFTForwardType::New(lineSize, numberOfLines, otherDirection);
+    if (RegistryType::GetNumberOfTunedSizes() != 3 || otherDirectionFFTForward->GetDirection() != otherDirection)
+    {
+      std::cerr << "Unexpected auto-tuning state along direction " << otherDirection << std::endl;
+      return EXIT_FAILURE;
+    }
+    RegistryType::ResetBackend();
+
+    return doTest<FFTForwardType, FFTInverseType>(argv[1], argv[2], direction, fftForward, fftInverse);
+  }
 
   std::cerr << "Backend " << backend << " (" << argv[3] << ") not implemented" << std::endl;
   return EXIT_FAILURE;
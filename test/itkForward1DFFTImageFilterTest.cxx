@@ -16,15 +16,19 @@
  *
  *=========================================================================*/
 
+#include <cmath>
 #include <complex>
 #include <string>
 
 #include "itkComplexToImaginaryImageFilter.h"
 #include "itkComplexToRealImageFilter.h"
+#include "itkConstantPadImageFilter.h"
+#include "itkImageRegionConstIterator.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
 #include "itkForward1DFFTImageFilter.h"
+#include "itkNativeForward1DFFTImageFilter.h"
 #include "itkVnlForward1DFFTImageFilter.h"
 #if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
 #  include "itkFFTWForward1DFFTImageFilter.h"
@@ -33,17 +37,46 @@
 #  include "itkOpenCLForward1DFFTImageFilter.h"
 #endif
 
+// compare the spectrum of output to the one of expected, from firstBin on
+// along the first dimension
+template <typename ComplexImageType>
+int
+compareSpectra(const ComplexImageType * output, const ComplexImageType * expected, itk::SizeValueType firstBin)
+{
+  itk::ImageRegionConstIterator<ComplexImageType> outputIt(output, output->GetLargestPossibleRegion());
+  for (; !outputIt.IsAtEnd(); ++outputIt)
+  {
+    typename ComplexImageType::IndexType index = outputIt.GetIndex();
+    index[0] += static_cast<itk::IndexValueType>(firstBin);
+    const typename ComplexImageType::PixelType value = expected->GetPixel(index);
+    if (std::abs(outputIt.Get() - value) > 1e-6 * (1.0 + std::abs(value)))
+    {
+      std::cerr << "Spectrum " << outputIt.Get() << " instead of " << value << " at " << outputIt.GetIndex()
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
 template <typename FFTType>
 int
-doTest(const char * inputImage, const char * outputImagePrefix)
+doTest(const char *       inputImage,
+       const char *       outputImagePrefix,
+       bool               halfSpectrum = false,
+       itk::SizeValueType paddedLineSize = 0,
+       itk::SizeValueType firstBin = 0,
+       itk::SizeValueType numberOfBins = 0)
 {
   using ImageType = typename FFTType::InputImageType;
   using ComplexImageType = typename FFTType::OutputImageType;
+  // the input pixels may be integers, the spectrum is written in the output precision
+  using RealImageType = itk::Image<typename ComplexImageType::PixelType::value_type, ComplexImageType::ImageDimension>;
 
   using ReaderType = itk::ImageFileReader<ImageType>;
-  using RealFilterType = itk::ComplexToRealImageFilter<ComplexImageType, ImageType>;
-  using ImaginaryFilterType = itk::ComplexToImaginaryImageFilter<ComplexImageType, ImageType>;
-  using WriterType = itk::ImageFileWriter<ImageType>;
+  using RealFilterType = itk::ComplexToRealImageFilter<ComplexImageType, RealImageType>;
+  using ImaginaryFilterType = itk::ComplexToImaginaryImageFilter<ComplexImageType, RealImageType>;
+  using WriterType = itk::ImageFileWriter<RealImageType>;
 
   typename ReaderType::Pointer          reader = ReaderType::New();
   typename FFTType::Pointer             fft = FFTType::New();
@@ -53,6 +86,10 @@ doTest(const char * inputImage, const char * outputImagePrefix)
 
   reader->SetFileName(inputImage);
   fft->SetInput(reader->GetOutput());
+  fft->SetHalfSpectrum(halfSpectrum);
+  fft->SetPaddedLineSize(paddedLineSize);
+  fft->SetFirstFrequencyBin(firstBin);
+  fft->SetNumberOfFrequencyBins(numberOfBins);
   realFilter->SetInput(fft->GetOutput());
   imaginaryFilter->SetInput(fft->GetOutput());
 
@@ -75,21 +112,152 @@ doTest(const char * inputImage, const char * outputImagePrefix)
 
   fft.Print(std::cout);
 
+  if (paddedLineSize > 0)
+  {
+    // the lines padded on the fly must have the spectrum of the lines of an
+    // image padded with zeros
+    using PadFilterType = itk::ConstantPadImageFilter<ImageType, ImageType>;
+    typename PadFilterType::Pointer padFilter = PadFilterType::New();
+    typename ImageType::SizeType    padSize;
+    padSize.Fill(0);
+    padSize[0] = paddedLineSize - reader->GetOutput()->GetLargestPossibleRegion().GetSize(0);
+    padFilter->SetPadUpperBound(padSize);
+    padFilter->SetInput(reader->GetOutput());
+    typename FFTType::Pointer paddedFFT = FFTType::New();
+    paddedFFT->SetInput(padFilter->GetOutput());
+    paddedFFT->SetHalfSpectrum(halfSpectrum);
+    paddedFFT->SetFirstFrequencyBin(firstBin);
+    paddedFFT->SetNumberOfFrequencyBins(numberOfBins);
+    try
+    {
+      paddedFFT->Update();
+    }
+    catch (itk::ExceptionObject & excep)
+    {
+      std::cerr << "Exception caught !" << std::endl;
+      std::cerr << excep << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    const ComplexImageType * output = fft->GetOutput();
+    const ComplexImageType * expected = paddedFFT->GetOutput();
+    if (output->GetLargestPossibleRegion() != expected->GetLargestPossibleRegion())
+    {
+      std::cerr << "Padded output region " << output->GetLargestPossibleRegion() << " instead of "
+                << expected->GetLargestPossibleRegion() << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (compareSpectra(output, expected, 0) != EXIT_SUCCESS)
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (numberOfBins > 0)
+  {
+    // the band must be the one of the whole spectrum
+    typename FFTType::Pointer fullFFT = FFTType::New();
+    fullFFT->SetInput(reader->GetOutput());
+    fullFFT->SetPaddedLineSize(paddedLineSize);
+    try
+    {
+      fullFFT->Update();
+    }
+    catch (itk::ExceptionObject & excep)
+    {
+      std::cerr << "Exception caught !" << std::endl;
+      std::cerr << excep << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (fft->GetOutput()->GetLargestPossibleRegion().GetSize(0) != numberOfBins ||
+        compareSpectra(fft->GetOutput(), fullFFT->GetOutput(), firstBin) != EXIT_SUCCESS)
+    {
+      std::cerr << "Wrong band of " << numberOfBins << " bins from bin " << firstBin << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   return EXIT_SUCCESS;
 }
 
+template <typename ImageType, typename ComplexImageType>
+int
+doBackendTest(int                backend,
+              const char *       inputImage,
+              const char *       outputImagePrefix,
+              bool               halfSpectrum,
+              itk::SizeValueType paddedLineSize,
+              itk::SizeValueType firstBin,
+              itk::SizeValueType numberOfBins)
+{
+  if (backend == 0)
+  {
+    using FFTForwardType = itk::Forward1DFFTImageFilter<ImageType, ComplexImageType>;
+    return doTest<FFTForwardType>(
+      inputImage, outputImagePrefix, halfSpectrum, paddedLineSize, firstBin, numberOfBins);
+  }
+  else if (backend == 1)
+  {
+    using FFTForwardType = itk::VnlForward1DFFTImageFilter<ImageType, ComplexImageType>;
+    return doTest<FFTForwardType>(
+      inputImage, outputImagePrefix, halfSpectrum, paddedLineSize, firstBin, numberOfBins);
+  }
+  else if (backend == 2)
+  {
+#if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
+    using FFTForwardType = itk::FFTWForward1DFFTImageFilter<ImageType, ComplexImageType>;
+#  ifndef ITK_USE_CUFFTW
+    // Measured plans produce wisdom that can be saved and restored
+    itk::FFTWGlobalConfiguration::SetPlanRigor(FFTW_MEASURE);
+    const int result =
+      doTest<FFTForwardType>(inputImage, outputImagePrefix, halfSpectrum, paddedLineSize, firstBin, numberOfBins);
+    const std::string wisdomFile = std::string(outputImagePrefix) + "Wisdom.txt";
+    if (!FFTForwardType::FFTW1DProxyType::ExportWisdomFile(wisdomFile) ||
+        !FFTForwardType::FFTW1DProxyType::ImportWisdomFile(wisdomFile))
+    {
+      std::cerr << "Could not round trip FFTW wisdom through " << wisdomFile << std::endl;
+      return EXIT_FAILURE;
+    }
+    return result;
+#  else
+    return doTest<FFTForwardType>(
+      inputImage, outputImagePrefix, halfSpectrum, paddedLineSize, firstBin, numberOfBins);
+#  endif
+#endif
+  }
+  else if (backend == 3)
+  {
+#if defined(ITKUltrasound_USE_clFFT)
+    using FFTForwardType = itk::OpenCLForward1DFFTImageFilter<ImageType, ComplexImageType>;
+    return doTest<FFTForwardType>(
+      inputImage, outputImagePrefix, halfSpectrum, paddedLineSize, firstBin, numberOfBins);
+#endif
+  }
+  else if (backend == 4)
+  {
+    using FFTForwardType = itk::NativeForward1DFFTImageFilter<ImageType, ComplexImageType>;
+    return doTest<FFTForwardType>(
+      inputImage, outputImagePrefix, halfSpectrum, paddedLineSize, firstBin, numberOfBins);
+  }
+
+  std::cerr << "Backend " << backend << " not implemented" << std::endl;
+  return EXIT_FAILURE;
+}
+
 int
 itkForward1DFFTImageFilterTest(int argc, char * argv[])
 {
   if (argc < 3)
   {
     std::cerr << "Usage: " << argv[0];
-    std::cerr << " inputImage outputImagePrefix [backend]\n";
+    std::cerr << " inputImage outputImagePrefix [backend] [halfSpectrum] [int16Input] [paddedLineSize]";
+    std::cerr << " [firstFrequencyBin numberOfFrequencyBins]\n";
     std::cerr << "backend implementation options:\n";
     std::cerr << "  0 default\n";
     std::cerr << "  1 VNL\n";
     std::cerr << "  2 FFTW\n";
     std::cerr << "  3 OpenCL via clFFT\n";
+    std::cerr << "  4 Native\n";
     std::cerr << std::flush;
     return EXIT_FAILURE;
   }
@@ -105,32 +273,36 @@ itkForward1DFFTImageFilterTest(int argc, char * argv[])
   {
     backend = std::stoi(argv[3]);
   }
-
-  if (backend == 0)
+  bool halfSpectrum = false;
+  if (argc > 4)
   {
-    using FFTForwardType = itk::Forward1DFFTImageFilter<ImageType, ComplexImageType>;
-    return doTest<FFTForwardType>(argv[1], argv[2]);
+    halfSpectrum = std::stoi(argv[4]) != 0;
   }
-  else if (backend == 1)
+  bool int16Input = false;
+  if (argc > 5)
   {
-    using FFTForwardType = itk::VnlForward1DFFTImageFilter<ImageType, ComplexImageType>;
-    return doTest<FFTForwardType>(argv[1], argv[2]);
+    int16Input = std::stoi(argv[5]) != 0;
   }
-  else if (backend == 2)
+  itk::SizeValueType paddedLineSize = 0;
+  if (argc > 6)
   {
-#if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
-    using FFTForwardType = itk::FFTWForward1DFFTImageFilter<ImageType, ComplexImageType>;
-    return doTest<FFTForwardType>(argv[1], argv[2]);
-#endif
+    paddedLineSize = std::stoul(argv[6]);
   }
-  else if (backend == 3)
+  itk::SizeValueType firstBin = 0;
+  itk::SizeValueType numberOfBins = 0;
+  if (argc > 8)
   {
-#if defined(ITKUltrasound_USE_clFFT)
-    using FFTForwardType = itk::OpenCLForward1DFFTImageFilter<ImageType, ComplexImageType>;
-    return doTest<FFTForwardType>(argv[1], argv[2]);
-#endif
+    firstBin = std::stoul(argv[7]);
+    numberOfBins = std::stoul(argv[8]);
   }
 
-  std::cerr << "Backend " << backend << " (" << argv[3] << ") not implemented" << std::endl;
-  return EXIT_FAILURE;
+  if (int16Input)
+  {
+    // RF samples are converted while the lines are gathered
+    using Int16ImageType = itk::Image<short, Dimension>;
+    return doBackendTest<Int16ImageType, ComplexImageType>(
+      backend, argv[1], argv[2], halfSpectrum, paddedLineSize, firstBin, numberOfBins);
+  }
+  return doBackendTest<ImageType, ComplexImageType>(
+      backend, argv[1], argv[2], halfSpectrum, paddedLineSize, firstBin, numberOfBins);
 }
@@ -0,0 +1,179 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkStreamingImageFilter.h"
+#include "itkTestingMacros.h"
+
+#include "itkBModeImageFilter.h"
+#include "itkHilbertFIRAnalyticSignalImageFilter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace
+{
+// largest difference between the pixels of two images of the same region
+template <typename TImage>
+double
+MaximumDifference(const TImage * image1, const TImage * image2)
+{
+  itk::ImageRegionConstIterator<TImage> it1(image1, image1->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<TImage> it2(image2, image1->GetLargestPossibleRegion());
+  double                                maximumDifference = 0.0;
+  for (; !it1.IsAtEnd(); ++it1, ++it2)
+  {
+    maximumDifference = std::max(maximumDifference, static_cast<double>(std::abs(it1.Get() - it2.Get())));
+  }
+  return maximumDifference;
+}
+} // namespace
+
+int
+itkHilbertFIRAnalyticSignalImageFilterTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " outputImage";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * outputImageFileName = argv[1];
+
+  const unsigned int Dimension = 2;
+  using PixelType = float;
+  using ImageType = itk::Image<PixelType, Dimension>;
+  using ComplexImageType = itk::Image<std::complex<PixelType>, Dimension>;
+
+  // lines of cosines along the slowest dimension, which the streaming
+  // filters split
+  const unsigned int direction = 1;
+  const unsigned int kernelRadius = 16;
+  const double       frequency = 0.3 * itk::Math::pi;
+
+  ImageType::SizeType size;
+  size[0] = 7;
+  size[1] = 301;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  for (itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetLargestPossibleRegion()); !it.IsAtEnd(); ++it)
+  {
+    const ImageType::IndexType & index = it.GetIndex();
+    it.Set(static_cast<PixelType>(std::cos(frequency * index[direction] + 0.4 * index[0])));
+  }
+
+  using AnalyticType = itk::HilbertFIRAnalyticSignalImageFilter<ImageType, ComplexImageType>;
+  AnalyticType::Pointer analytic = AnalyticType::New();
+  analytic->SetInput(image);
+  analytic->SetDirection(direction);
+  analytic->SetKernelRadius(kernelRadius);
+  analytic->Print(std::cout);
+  ITK_TRY_EXPECT_NO_EXCEPTION(analytic->Update());
+  ComplexImageType::Pointer analyticOutput = analytic->GetOutput();
+  analyticOutput->DisconnectPipeline();
+
+  // the analytic signal of a cosine away from the ends of the lines
+  const auto firstInterior = static_cast<itk::IndexValueType>(kernelRadius);
+  const auto lastInterior = static_cast<itk::IndexValueType>(size[direction] - kernelRadius) - 1;
+  double     maximumError = 0.0;
+  using ComplexIteratorType = itk::ImageRegionConstIteratorWithIndex<ComplexImageType>;
+  for (ComplexIteratorType it(analyticOutput, analyticOutput->GetLargestPossibleRegion()); !it.IsAtEnd(); ++it)
+  {
+    const ComplexImageType::IndexType & index = it.GetIndex();
+    if (index[direction] < firstInterior || index[direction] > lastInterior)
+    {
+      continue;
+    }
+    const std::complex<double> expected = std::polar(1.0, frequency * index[direction] + 0.4 * index[0]);
+    maximumError = std::max(maximumError, std::abs(std::complex<double>(it.Get()) - expected));
+  }
+  std::cout << "Analytic signal error: " << maximumError << std::endl;
+  if (maximumError > 1e-3)
+  {
+    std::cerr << "The analytic signal differs from the expected one by " << maximumError << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // streamed along the direction, only a halo of the input is read
+  using ComplexStreamerType = itk::StreamingImageFilter<ComplexImageType, ComplexImageType>;
+  ComplexStreamerType::Pointer analyticStreamer = ComplexStreamerType::New();
+  analyticStreamer->SetInput(analytic->GetOutput());
+  analyticStreamer->SetNumberOfStreamDivisions(5);
+  ITK_TRY_EXPECT_NO_EXCEPTION(analyticStreamer->Update());
+  const double analyticStreamingDifference =
+    MaximumDifference<ComplexImageType>(analyticStreamer->GetOutput(), analyticOutput);
+  if (analyticStreamingDifference > 1e-5)
+  {
+    std::cerr << "The streamed analytic signal differs by " << analyticStreamingDifference << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // the B-mode envelope of unit cosines is log10(2)
+  using BModeType = itk::BModeImageFilter<ImageType, ImageType>;
+  BModeType::Pointer bMode = BModeType::New();
+  bMode->SetInput(image);
+  bMode->SetDirection(direction);
+  bMode->SetEnvelopeMethod(BModeType::EnvelopeMethodEnum::HilbertFIR);
+  bMode->SetHilbertFIRKernelRadius(kernelRadius);
+  bMode->Print(std::cout);
+  ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+  ImageType::Pointer bModeOutput = bMode->GetOutput();
+  bModeOutput->DisconnectPipeline();
+
+  ImageType::IndexType centerIndex;
+  centerIndex[0] = 3;
+  centerIndex[1] = 150;
+  const double envelopeError = std::abs(bModeOutput->GetPixel(centerIndex) - std::log10(2.0));
+  if (envelopeError > 1e-3)
+  {
+    std::cerr << "The B-mode envelope differs from log10(2) by " << envelopeError << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using StreamerType = itk::StreamingImageFilter<ImageType, ImageType>;
+  StreamerType::Pointer bModeStreamer = StreamerType::New();
+  bModeStreamer->SetInput(bMode->GetOutput());
+  bModeStreamer->SetNumberOfStreamDivisions(5);
+  ITK_TRY_EXPECT_NO_EXCEPTION(bModeStreamer->Update());
+  const double bModeStreamingDifference = MaximumDifference<ImageType>(bModeStreamer->GetOutput(), bModeOutput);
+  if (bModeStreamingDifference > 1e-5)
+  {
+    std::cerr << "The streamed B-mode image differs by " << bModeStreamingDifference << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using WriterType = itk::ImageFileWriter<ImageType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName(outputImageFileName);
+  writer->SetInput(bModeStreamer->GetOutput());
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -24,6 +24,7 @@
 #include "itkImageFileWriter.h"
 
 #include "itkInverse1DFFTImageFilter.h"
+#include "itkNativeInverse1DFFTImageFilter.h"
 #include "itkVnlInverse1DFFTImageFilter.h"
 #if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
 #  include "itkFFTWInverse1DFFTImageFilter.h"
@@ -34,7 +35,7 @@
 
 template <typename FFTType>
 int
-doTest(const char * inputImagePrefix, const char * outputImage)
+doTest(const char * inputImagePrefix, const char * outputImage, bool halfSpectrum = false, bool hermitianInput = false)
 {
   using ImageType = typename FFTType::OutputImageType;
   using ComplexImageType = typename FFTType::InputImageType;
@@ -49,11 +50,14 @@ doTest(const char * inputImagePrefix, const char * outputImage)
   typename JoinFilterType::Pointer joinFilter = JoinFilterType::New();
   typename WriterType::Pointer     writer = WriterType::New();
 
-  readerReal->SetFileName(std::string(inputImagePrefix) + "RealFull.mhd");
-  readerImag->SetFileName(std::string(inputImagePrefix) + "ImaginaryFull.mhd");
+  const std::string spectrum = halfSpectrum ? "NotFull.mhd" : "Full.mhd";
+  readerReal->SetFileName(std::string(inputImagePrefix) + "Real" + spectrum);
+  readerImag->SetFileName(std::string(inputImagePrefix) + "Imaginary" + spectrum);
   joinFilter->SetInput1(readerReal->GetOutput());
   joinFilter->SetInput2(readerImag->GetOutput());
   fft->SetInput(joinFilter->GetOutput());
+  fft->SetHalfSpectrum(halfSpectrum);
+  fft->SetHermitianInput(hermitianInput);
   writer->SetInput(fft->GetOutput());
   writer->SetFileName(outputImage);
 
@@ -79,12 +83,13 @@ itkInverse1DFFTImageFilterTest(int argc, char * argv[])
   if (argc < 3)
   {
     std::cerr << "Usage: " << argv[0];
-    std::cerr << " inputImagePrefix outputImage [backend]\n";
+    std::cerr << " inputImagePrefix outputImage [backend] [halfSpectrum] [hermitianInput]\n";
     std::cerr << "backend implementation options:\n";
     std::cerr << "  0 default\n";
     std::cerr << "  1 VNL\n";
     std::cerr << "  2 FFTW\n";
     std::cerr << "  3 OpenCL via clFFT\n";
+    std::cerr << "  4 Native\n";
     std::cerr << std::flush;
     return EXIT_FAILURE;
   }
@@ -100,31 +105,46 @@ itkInverse1DFFTImageFilterTest(int argc, char * argv[])
   {
     backend = std::stoi(argv[3]);
   }
+  bool halfSpectrum = false;
+  if (argc > 4)
+  {
+    halfSpectrum = std::stoi(argv[4]) != 0;
+  }
+  bool hermitianInput = false;
+  if (argc > 5)
+  {
+    hermitianInput = std::stoi(argv[5]) != 0;
+  }
 
   if (backend == 0)
   {
     using FFTInverseType = itk::Inverse1DFFTImageFilter<ComplexImageType, ImageType>;
-    return doTest<FFTInverseType>(argv[1], argv[2]);
+    return doTest<FFTInverseType>(argv[1], argv[2], halfSpectrum, hermitianInput);
   }
   else if (backend == 1)
   {
     using FFTInverseType = itk::VnlInverse1DFFTImageFilter<ComplexImageType, ImageType>;
-    return doTest<FFTInverseType>(argv[1], argv[2]);
+    return doTest<FFTInverseType>(argv[1], argv[2], halfSpectrum, hermitianInput);
   }
   else if (backend == 2)
   {
 #if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
     using FFTInverseType = itk::FFTWInverse1DFFTImageFilter<ComplexImageType, ImageType>;
-    return doTest<FFTInverseType>(argv[1], argv[2]);
+    return doTest<FFTInverseType>(argv[1], argv[2], halfSpectrum, hermitianInput);
 #endif
   }
   else if (backend == 3)
   {
 #if defined(ITKUltrasound_USE_clFFT)
     using FFTInverseType = itk::OpenCLInverse1DFFTImageFilter<ComplexImageType, ImageType>;
-    return doTest<FFTInverseType>(argv[1], argv[2]);
+    return doTest<FFTInverseType>(argv[1], argv[2], halfSpectrum, hermitianInput);
 #endif
   }
+  else if (backend == 4)
+  {
+    using FFTInverseType = itk::NativeInverse1DFFTImageFilter<ComplexImageType, ImageType>;
+    return doTest<FFTInverseType>(argv[1], argv[2], halfSpectrum, hermitianInput);
+  }
 
   std::cerr << "Backend " << backend << " (" << argv[3] << ") not implemented" << std::endl;
   return EXIT_FAILURE;